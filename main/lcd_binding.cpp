@@ -0,0 +1,84 @@
+#include <string.h>
+
+#include "lcd_binding.h"
+
+LcdBinding LcdBinding::of(const volatile uint32_t *value, uint8_t col, uint8_t row, LcdFieldFormat format)
+{
+    return LcdBinding(VOLATILE_U32, (const void *)value, nullptr, col, row, format);
+}
+
+LcdBinding LcdBinding::of(const volatile int32_t *value, uint8_t col, uint8_t row, LcdFieldFormat format)
+{
+    return LcdBinding(VOLATILE_I32, (const void *)value, nullptr, col, row, format);
+}
+
+LcdBinding LcdBinding::of(const std::atomic<uint32_t> *value, uint8_t col, uint8_t row, LcdFieldFormat format)
+{
+    return LcdBinding(ATOMIC_U32, value, nullptr, col, row, format);
+}
+
+LcdBinding LcdBinding::of(const std::atomic<int32_t> *value, uint8_t col, uint8_t row, LcdFieldFormat format)
+{
+    return LcdBinding(ATOMIC_I32, value, nullptr, col, row, format);
+}
+
+LcdBinding LcdBinding::of(lcd_getter_t getter, void *ctx, uint8_t col, uint8_t row, LcdFieldFormat format)
+{
+    return LcdBinding(GETTER, (const void *)getter, ctx, col, row, format);
+}
+
+int64_t LcdBinding::read() const
+{
+    switch (_kind) {
+    case VOLATILE_U32: return *static_cast<const volatile uint32_t *>(_source);
+    case VOLATILE_I32: return *static_cast<const volatile int32_t *>(_source);
+    case ATOMIC_U32: return static_cast<const std::atomic<uint32_t> *>(_source)->load(std::memory_order_relaxed);
+    case ATOMIC_I32: return static_cast<const std::atomic<int32_t> *>(_source)->load(std::memory_order_relaxed);
+    case GETTER: return ((lcd_getter_t)_source)(_ctx);
+    }
+    return 0;
+}
+
+bool LcdBinding::sample(LcdFrame &frame)
+{
+    int64_t value = read();
+    if (_valid && value == _last) return false;
+    _last = value;
+    _valid = true;
+
+    char text[24];
+    lcd_format_decimal(value, _format, text);
+    frame.put(_col, _row, text);
+    return true;
+}
+
+void lcd_format_decimal(int64_t value, LcdFieldFormat format, char *out)
+{
+    uint8_t width = format.width < 23 ? format.width : 23;
+    uint8_t decimals = format.decimals < 20 ? format.decimals : 20;
+    bool negative = value < 0;
+    uint64_t magnitude = negative ? 0 - (uint64_t)value : (uint64_t)value;
+
+    char digits[24]; // reverse order
+    int n = 0;
+    while (true) {
+        digits[n++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+        if (decimals && n == decimals) digits[n++] = '.';
+        if (magnitude == 0 && n > decimals && digits[n - 1] != '.') break;
+    }
+
+    int used = n + (negative ? 1 : 0);
+    if (used > width) {
+        memset(out, '#', width);
+        out[width] = '\0';
+        return;
+    }
+    int pos = 0;
+    char fill = format.zero_pad ? '0' : ' ';
+    if (negative && format.zero_pad) out[pos++] = '-';
+    while (pos < width - n - ((negative && !format.zero_pad) ? 1 : 0)) out[pos++] = fill;
+    if (negative && !format.zero_pad) out[pos++] = '-';
+    while (n) out[pos++] = digits[--n];
+    out[pos] = '\0';
+}
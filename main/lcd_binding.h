@@ -0,0 +1,66 @@
+/**
+ * @file lcd_binding.h
+ * @brief Fields bound to variables and sampled by the renderer at frame time.
+ *
+ * A producer such as an ISR counter only stores its value; it never formats or
+ * publishes anything. When the renderer plans a frame it reads every bound variable,
+ * and only a value that differs from the last sample is formatted into the frame.
+ */
+#pragma once
+
+#include <atomic>
+
+#include "lcd_frame.h"
+
+typedef int32_t (*lcd_getter_t)(void *ctx);
+
+/**
+ * @brief Decimal field layout: right aligned in @p width cells.
+ */
+struct LcdFieldFormat {
+    uint8_t width;
+    uint8_t decimals; /*!< fixed point: 235 with 1 decimal shows as 23.5 */
+    bool zero_pad;
+};
+
+class LcdBinding {
+public:
+    static LcdBinding of(const volatile uint32_t *value, uint8_t col, uint8_t row, LcdFieldFormat format);
+    static LcdBinding of(const volatile int32_t *value, uint8_t col, uint8_t row, LcdFieldFormat format);
+    static LcdBinding of(const std::atomic<uint32_t> *value, uint8_t col, uint8_t row, LcdFieldFormat format);
+    static LcdBinding of(const std::atomic<int32_t> *value, uint8_t col, uint8_t row, LcdFieldFormat format);
+    static LcdBinding of(lcd_getter_t getter, void *ctx, uint8_t col, uint8_t row, LcdFieldFormat format);
+
+    /**
+     * @brief Read the source and draw it into @p frame if it changed.
+     * @return true if the field was redrawn
+     */
+    bool sample(LcdFrame &frame);
+
+    void invalidate() { _valid = false; } // redraw on the next sample
+
+    uint8_t col() const { return _col; }
+    uint8_t row() const { return _row; }
+
+private:
+    enum Kind : uint8_t { VOLATILE_U32, VOLATILE_I32, ATOMIC_U32, ATOMIC_I32, GETTER };
+
+    LcdBinding(Kind kind, const void *source, void *ctx, uint8_t col, uint8_t row, LcdFieldFormat format)
+        : _kind(kind), _col(col), _row(row), _valid(false), _format(format), _source(source), _ctx(ctx), _last(0) {}
+
+    int64_t read() const;
+
+    Kind _kind;
+    uint8_t _col;
+    uint8_t _row;
+    bool _valid;
+    LcdFieldFormat _format;
+    const void *_source;
+    void *_ctx;
+    int64_t _last;
+};
+
+/**
+ * @brief Format @p value into exactly @p format.width cells; '#' fill when it does not fit.
+ */
+void lcd_format_decimal(int64_t value, LcdFieldFormat format, char *out);
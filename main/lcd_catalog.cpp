@@ -0,0 +1,35 @@
+#include "lcd_catalog.h"
+
+esp_err_t LcdCatalog::set_language(uint8_t language)
+{
+    if (language >= _count) return ESP_ERR_INVALID_ARG;
+    _table.store(&_tables[language], std::memory_order_relaxed);
+    return ESP_OK;
+}
+
+LcdCatalogText LcdCatalog::text(uint16_t id) const
+{
+    const LcdCatalogTable *table = _table.load(std::memory_order_relaxed);
+    if (id >= table->count) return {table->cells, 0, 0};
+    uint16_t start = table->offsets[id];
+    return {&table->cells[start], (uint8_t)(table->offsets[id + 1] - start), table->needs[id]};
+}
+
+size_t LcdCatalog::load_glyphs(LcdSettings &settings, uint8_t slots) const
+{
+    const LcdCatalogTable *table = _table.load(std::memory_order_relaxed);
+    uint8_t page[LCD_CGRAM_SLOTS];
+    for (uint8_t slot = 0; slot < LCD_CGRAM_SLOTS; slot++) {
+        page[slot] = (slots & (1 << slot)) ? table->slots[slot] : LCD_GLYPH_NONE;
+    }
+    return settings.load_glyph_page(_glyphs, page);
+}
+
+uint8_t LcdCatalog::put(LcdRegion *region, uint8_t col, uint8_t row, uint16_t id) const
+{
+    if (col >= region->width()) return 0;
+    LcdCatalogText message = text(id);
+    uint8_t len = message.len > region->width() - col ? region->width() - col : message.len;
+    region->put_cells(col, row, message.cells, len);
+    return len;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file lcd_catalog.h
+ * @brief Localized messages, encoded for the display at build time.
+ *
+ * tools/catalog_gen compiles a UTF-8 message catalog into a header of flash tables, one
+ * per language: the cells of every message in the display's character set, ROM codes
+ * where the A00 ROM has the character and CGRAM codes where the catalog defines a glyph
+ * for it. Nothing is translated or copied at run time. A message is two offset reads
+ * into its language's table, and switching languages swaps one pointer.
+ *
+ * Each language has its own CGRAM slot assignment for its glyphs. Each message records
+ * the slots it needs, so glyphs can be loaded once per language or on first use:
+ *
+ *     #include "lcd_catalog_messages.h" // generated
+ *
+ *     static LcdCatalog messages(lcd_catalog_tables, LCD_LANG_COUNT, lcd_catalog_glyphs);
+ *     messages.set_language(LCD_LANG_DE);
+ *     messages.load_glyphs(settings);
+ *     messages.put(region, 0, 0, LCD_MSG_ALARM_HIGH);
+ */
+#pragma once
+
+#include <atomic>
+
+#include "lcd_region.h"
+#include "lcd_settings.h"
+
+/**
+ * @brief One language of a generated catalog.
+ */
+struct LcdCatalogTable {
+    const char *language;
+    uint16_t count;          /*!< messages */
+    const uint16_t *offsets; /*!< count + 1 offsets into cells */
+    const uint8_t *cells;    /*!< every message back to back, display codes */
+    const uint8_t *needs;    /*!< per message, bit per CGRAM slot its cells use */
+    uint8_t slots[LCD_CGRAM_SLOTS]; /*!< catalog glyph per slot, LCD_GLYPH_NONE if the language leaves it alone */
+};
+
+struct LcdCatalogText {
+    const uint8_t *cells;
+    uint8_t len;
+    uint8_t needs; /*!< CGRAM slots the cells use */
+};
+
+class LcdCatalog {
+public:
+    LcdCatalog(const LcdCatalogTable *tables, uint8_t count, const LcdGlyph *glyphs)
+        : _tables(tables), _count(count), _glyphs(glyphs), _table(tables) {}
+
+    esp_err_t set_language(uint8_t language); // ESP_ERR_INVALID_ARG past the last one
+    const char *language() const { return _table.load(std::memory_order_relaxed)->language; }
+
+    /**
+     * @brief Cells of message @p id in the current language; empty for an unknown id.
+     */
+    LcdCatalogText text(uint16_t id) const;
+
+    /**
+     * @brief Queue the current language's glyphs for the CGRAM slots in @p slots.
+     * @return number of slots queued for loading; glyphs already there are skipped
+     */
+    size_t load_glyphs(LcdSettings &settings, uint8_t slots = 0xFF) const;
+
+    /**
+     * @brief Write message @p id into @p region, clipped to it.
+     * @return cells written
+     */
+    uint8_t put(LcdRegion *region, uint8_t col, uint8_t row, uint16_t id) const;
+
+private:
+    const LcdCatalogTable *_tables;
+    uint8_t _count;
+    const LcdGlyph *_glyphs;
+    std::atomic<const LcdCatalogTable *> _table;
+};
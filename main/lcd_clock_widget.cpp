@@ -0,0 +1,178 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "lcd_clock_widget.h"
+
+#define US_PER_S 1000000LL
+
+LcdClockWidget::LcdClockWidget(LcdRegion *region, uint8_t col, uint8_t row, LcdClockFormat format)
+    : _region(region), _col(col), _row(row), _format(format)
+{
+    _shown[0] = '\0';
+    set(0);
+}
+
+LcdClockWidget::~LcdClockWidget()
+{
+    stop();
+}
+
+void LcdClockWidget::set(uint32_t seconds)
+{
+    uint32_t days = seconds / 86400;
+    uint32_t rest = seconds % 86400;
+    uint8_t h = (uint8_t)(rest / 3600), m = (uint8_t)(rest / 60 % 60), s = (uint8_t)(rest % 60);
+
+    char buf[12];
+    int n = snprintf(buf, sizeof(buf), "%lu", (unsigned long)days);
+    if (n > LCD_CLOCK_MAX_DAY_DIGITS) n = LCD_CLOCK_MAX_DAY_DIGITS;
+    memcpy(_days, buf + strlen(buf) - n, n);
+    _days[n] = '\0';
+    _hours[0] = (char)('0' + h / 10);   _hours[1] = (char)('0' + h % 10);
+    _minutes[0] = (char)('0' + m / 10); _minutes[1] = (char)('0' + m % 10);
+    _seconds[0] = (char)('0' + s / 10); _seconds[1] = (char)('0' + s % 10);
+    render();
+}
+
+/**
+ * @brief Increment a two digit field whose top value is @p tens_limit @p ones_limit_at_top.
+ * @return true when it wrapped to "00"
+ */
+static bool advance(char digits[2], char tens_limit, char ones_limit_at_top)
+{
+    if (++digits[1] <= '9' && !(digits[0] == tens_limit && digits[1] > ones_limit_at_top)) return false;
+    digits[1] = '0';
+    if (digits[0] == tens_limit) {
+        digits[0] = '0';
+        return true;
+    }
+    digits[0]++;
+    return false;
+}
+
+void LcdClockWidget::tick()
+{
+    bool carry = advance(_seconds, '5', '9') && advance(_minutes, '5', '9') && advance(_hours, '2', '3');
+    if (carry) {
+        // ripple the day counter; grow by one digit on overflow
+        int i = (int)strlen(_days) - 1;
+        while (i >= 0 && _days[i] == '9') _days[i--] = '0';
+        if (i >= 0) {
+            _days[i]++;
+        } else if (strlen(_days) < LCD_CLOCK_MAX_DAY_DIGITS) {
+            memmove(_days + 1, _days, strlen(_days) + 1);
+            _days[0] = '1';
+        }
+    }
+    render();
+}
+
+void LcdClockWidget::render()
+{
+    char text[sizeof(_shown)];
+    size_t n = 0;
+    if (_format == LCD_CLOCK_DHM) {
+        size_t d = strlen(_days);
+        memcpy(text, _days, d);
+        n = d;
+        text[n++] = ':';
+        text[n++] = _hours[0]; text[n++] = _hours[1];
+        text[n++] = ':';
+        text[n++] = _minutes[0]; text[n++] = _minutes[1];
+    } else {
+        text[n++] = _hours[0]; text[n++] = _hours[1];
+        text[n++] = ':';
+        text[n++] = _minutes[0]; text[n++] = _minutes[1];
+        text[n++] = ':';
+        text[n++] = _seconds[0]; text[n++] = _seconds[1];
+    }
+    text[n] = '\0';
+
+    if (!_region) {
+        memcpy(_shown, text, n + 1);
+        return;
+    }
+    size_t shown = strlen(_shown);
+    if (shown != n) {
+        _region->put(_col, _row, text); // layout changed: a day digit was added, or set() dropped some
+        for (size_t i = n; i < shown; i++) _region->put_char((uint8_t)(_col + i), _row, ' ');
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            if (text[i] != _shown[i]) _region->put_char((uint8_t)(_col + i), _row, (uint8_t)text[i]);
+        }
+    }
+    memcpy(_shown, text, n + 1);
+}
+
+#ifdef ESP_PLATFORM
+
+static const char *TAG = "lcd clock";
+
+void LcdClockWidget::timer_cb(void *arg)
+{
+    LcdClockWidget *self = static_cast<LcdClockWidget *>(arg);
+    int64_t now = esp_timer_get_time();
+    // catch up if the timer task was held off past whole seconds
+    do {
+        self->tick();
+        self->_next_us += US_PER_S;
+    } while (self->_next_us - self->_lead_us <= now);
+    esp_timer_start_once(self->_timer, self->_next_us - self->_lead_us - now);
+    if (self->_on_tick) self->_on_tick(self->_ctx);
+}
+
+esp_err_t LcdClockWidget::start(int64_t origin_us, int64_t lead_us, void (*on_tick)(void *ctx), void *ctx)
+{
+    if (lead_us < 0 || lead_us >= US_PER_S) return ESP_ERR_INVALID_ARG;
+    _lead_us = lead_us;
+    _on_tick = on_tick;
+    _ctx = ctx;
+
+    if (!_timer) {
+        const esp_timer_create_args_t args = {
+            .callback = &LcdClockWidget::timer_cb,
+            .arg = this,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "lcd_clock",
+            .skip_unhandled_events = true,
+        };
+        esp_err_t err = esp_timer_create(&args, &_timer);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "esp_timer_create failed: %s", esp_err_to_name(err));
+            return err;
+        }
+    } else {
+        esp_timer_stop(_timer);
+    }
+
+    // show the second we are in now and wake for the next boundary
+    int64_t now = esp_timer_get_time();
+    int64_t elapsed = now > origin_us ? now - origin_us : 0;
+    set((uint32_t)(elapsed / US_PER_S));
+    _next_us = origin_us + (elapsed / US_PER_S + 1) * US_PER_S;
+    int64_t delay = _next_us - _lead_us - now;
+    return esp_timer_start_once(_timer, delay > 0 ? delay : 0);
+}
+
+void LcdClockWidget::stop()
+{
+    if (_timer) {
+        esp_timer_stop(_timer);
+        esp_timer_delete(_timer);
+        _timer = nullptr;
+    }
+}
+
+#else // host build: no esp_timer, tick() is driven by the caller
+
+esp_err_t LcdClockWidget::start(int64_t origin_us, int64_t lead_us, void (*on_tick)(void *ctx), void *ctx)
+{
+    (void)origin_us; (void)lead_us; (void)on_tick; (void)ctx;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void LcdClockWidget::stop()
+{
+}
+
+#endif
@@ -0,0 +1,73 @@
+/**
+ * @file lcd_clock_widget.h
+ * @brief HH:MM:SS clock and D:HH:MM uptime widget that ticks from an esp_timer.
+ *
+ * The widget keeps its digits as characters and advances them with a ripple carry, so a
+ * tick never divides. Only the characters that changed are written into its region,
+ * which means the renderer usually sends a single changed cell per second.
+ *
+ * The timer is re-armed against absolute second boundaries (origin + n seconds), so
+ * ticks do not drift, and it fires @p lead_us early so the new second has reached the
+ * device when the boundary passes.
+ */
+#pragma once
+
+#include "lcd_port.h"
+#include "lcd_region.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_timer.h"
+#endif
+
+enum LcdClockFormat {
+    LCD_CLOCK_HMS, /*!< "HH:MM:SS", wraps at 24 h; wall clock or short uptimes */
+    LCD_CLOCK_DHM, /*!< "D:HH:MM", days grow as needed; long uptimes */
+};
+
+#define LCD_CLOCK_MAX_DAY_DIGITS 5
+
+class LcdClockWidget {
+public:
+    LcdClockWidget(LcdRegion *region, uint8_t col, uint8_t row, LcdClockFormat format);
+    ~LcdClockWidget();
+
+    void set(uint32_t seconds); // the one place that divides
+    void tick();                // advance one second and redraw changed characters
+
+    const char *text() const { return _shown; }
+
+    /**
+     * @brief Tick at every second boundary after @p origin_us on the esp_timer clock.
+     *
+     * @param origin_us time at which the widget reads zero (0 for uptime)
+     * @param lead_us   how early to tick, roughly the time a frame takes to reach the device
+     * @param on_tick   called from the timer task after each tick, e.g. to wake the renderer
+     */
+    esp_err_t start(int64_t origin_us, int64_t lead_us, void (*on_tick)(void *ctx) = nullptr, void *ctx = nullptr);
+    void stop();
+
+private:
+    void render();
+#ifdef ESP_PLATFORM
+    static void timer_cb(void *arg);
+    esp_timer_handle_t _timer = nullptr;
+#endif
+
+    LcdRegion *_region;
+    uint8_t _col;
+    uint8_t _row;
+    LcdClockFormat _format;
+
+    // digits as characters, most significant first
+    char _days[LCD_CLOCK_MAX_DAY_DIGITS + 1];
+    char _hours[2];
+    char _minutes[2];
+    char _seconds[2];
+
+    char _shown[LCD_CLOCK_MAX_DAY_DIGITS + 10]; // what the region holds
+
+    int64_t _next_us = 0;
+    int64_t _lead_us = 0;
+    void (*_on_tick)(void *ctx) = nullptr;
+    void *_ctx = nullptr;
+};
@@ -0,0 +1,53 @@
+/**
+ * @file lcd_device_state.h
+ * @brief What the engine knows about a display besides its DDRAM: CGRAM and settings.
+ *
+ * Every field has a "known" bit. Unknown state is always sent; known state that
+ * already matches is never sent again. A "wanted" bit records that the application
+ * set the field: if the command then fails, is cancelled or is lost in a brownout,
+ * the known bit is cleared and LcdSettings::restore() sends the field again.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#define LCD_CGRAM_SLOTS 8
+#define LCD_GLYPH_ROWS 8
+#define LCD_GLYPH_NONE 0xFF /*!< slot-table entry for a slot a page leaves alone */
+
+#define LCD_KNOWN_CONTRAST   (1 << 0)
+#define LCD_KNOWN_BACKLIGHT  (1 << 1)
+#define LCD_KNOWN_DISPLAY    (1 << 2)
+#define LCD_KNOWN_SPLASH     (1 << 3)
+#define LCD_KNOWN_MESSAGES   (1 << 4)
+#define LCD_KNOWN_SHIFT      (1 << 5)
+
+/**
+ * @brief A 5x8 custom character; bits 4..0 of each row, top row first.
+ */
+struct LcdGlyph {
+    uint8_t rows[LCD_GLYPH_ROWS];
+
+    bool operator==(const LcdGlyph &other) const = default;
+};
+
+struct LcdDeviceState {
+    uint8_t cgram[LCD_CGRAM_SLOTS][LCD_GLYPH_ROWS]; /*!< glyph patterns on the device */
+    uint8_t cgram_known;                            /*!< bit per slot whose content is known */
+    uint8_t cgram_wanted;                           /*!< bit per slot the application loaded; cgram[] holds it */
+    uint8_t known;                                  /*!< LCD_KNOWN_* bits */
+    uint8_t wanted;                                 /*!< LCD_KNOWN_* bits the application set; the fields hold its values */
+    uint8_t contrast;
+    uint8_t shift;                                  /*!< display shifted left by this many columns */
+    uint8_t red, green, blue;
+    bool display_on;
+    bool splash_on;
+    bool messages_on;                               /*!< firmware system messages */
+    bool messages_wanted;                           /*!< LcdSettings::set_messages(true) was called; kept by forget() */
+
+    void forget() // the device lost its state; what is wanted stays
+    {
+        cgram_known = 0;
+        known = 0;
+    }
+};
@@ -0,0 +1,119 @@
+#include <string.h>
+
+#include "lcd_diff.h"
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#if UINTPTR_MAX > 0xFFFFFFFFu
+typedef uint64_t lcd_word_t; // 64-bit hosts
+#else
+typedef uint32_t lcd_word_t; // ESP32 family
+#endif
+
+#if CONFIG_LCD_DIFF_USE_PIE
+/**
+ * @brief OR of target ^ shadow over @p blocks 16-byte blocks (lcd_diff_pie.S, ESP32-S3 only).
+ */
+extern "C" uint32_t lcd_diff_row_any_pie(const uint8_t *target, const uint8_t *shadow, uint32_t blocks);
+#endif
+
+#define LCD_WORD_LOWS  ((lcd_word_t)~(lcd_word_t)0 / 0xFF) /*!< 0x01 in every byte */
+#define LCD_WORD_HIGHS (LCD_WORD_LOWS * 0x80)               /*!< 0x80 in every byte */
+
+/**
+ * @brief High bit of every non-zero byte of @p x, no carries between bytes.
+ */
+static inline lcd_word_t changed_bytes(lcd_word_t x)
+{
+    lcd_word_t low7 = LCD_WORD_LOWS * 0x7F;
+    return (((x & low7) + low7) | x) & LCD_WORD_HIGHS;
+}
+
+static inline lcd_word_t load_word(const uint8_t *p)
+{
+    lcd_word_t w;
+    memcpy(&w, p, sizeof(w)); // aligned by construction; compiles to a single load
+    return w;
+}
+
+/**
+ * @brief Word-wise compare of one row, appending runs of differing cells.
+ */
+static size_t diff_row(const uint8_t *t, const uint8_t *s, uint8_t row, uint8_t cols, std::vector<LcdRun> &runs)
+{
+    size_t before = runs.size();
+    int start = -1; // first column of the open run
+    for (size_t base = 0; base < cols; base += sizeof(lcd_word_t)) {
+        lcd_word_t x = load_word(t + base) ^ load_word(s + base);
+        if (x == 0) {
+            if (start >= 0) {
+                runs.push_back({row, (uint8_t)start, (uint8_t)(base - start)});
+                start = -1;
+            }
+            continue;
+        }
+        // little endian: byte i of the word is cell base + i; hop between run edges with ctz
+        lcd_word_t changed = changed_bytes(x);
+        lcd_word_t same = ~changed & LCD_WORD_HIGHS;
+        size_t limit = (cols - base < sizeof(lcd_word_t)) ? cols - base : sizeof(lcd_word_t);
+        size_t i = 0;
+        while (i < limit) {
+            lcd_word_t edge = (start < 0 ? changed : same) >> (8 * i);
+            if (edge == 0) break;
+            i += (size_t)__builtin_ctzll(edge) / 8;
+            if (i >= limit) break;
+            if (start < 0) {
+                start = (int)(base + i);
+            } else {
+                runs.push_back({row, (uint8_t)start, (uint8_t)(base + i - start)});
+                start = -1;
+            }
+        }
+    }
+    if (start >= 0) runs.push_back({row, (uint8_t)start, (uint8_t)(cols - start)});
+    return runs.size() - before;
+}
+
+size_t lcd_diff(const uint8_t *target, const uint8_t *shadow, size_t stride, uint8_t cols, uint8_t rows,
+                uint64_t &dirty, std::vector<LcdRun> &runs)
+{
+    size_t before = runs.size();
+    uint64_t pending = dirty;
+    if (rows < 64) pending &= ((uint64_t)1 << rows) - 1;
+    while (pending) {
+        uint8_t row = (uint8_t)__builtin_ctzll(pending);
+        pending &= pending - 1;
+        const uint8_t *t = target + row * stride;
+        const uint8_t *s = shadow + row * stride;
+#if CONFIG_LCD_DIFF_USE_PIE
+        if (lcd_diff_row_any_pie(t, s, (uint32_t)(stride / 16)) == 0) {
+            dirty &= ~((uint64_t)1 << row);
+            continue;
+        }
+#endif
+        if (diff_row(t, s, row, cols, runs) == 0) {
+            dirty &= ~((uint64_t)1 << row);
+        }
+    }
+    return runs.size() - before;
+}
+
+size_t lcd_diff_bytewise(const uint8_t *target, const uint8_t *shadow, size_t stride, uint8_t cols, uint8_t rows,
+                         std::vector<LcdRun> &runs)
+{
+    size_t before = runs.size();
+    for (uint8_t row = 0; row < rows; row++) {
+        const uint8_t *t = target + row * stride;
+        const uint8_t *s = shadow + row * stride;
+        uint8_t col = 0;
+        while (col < cols) {
+            if (t[col] == s[col]) { col++; continue; }
+            uint8_t start = col;
+            while (col < cols && t[col] != s[col]) col++;
+            runs.push_back({row, start, (uint8_t)(col - start)});
+        }
+    }
+    return runs.size() - before;
+}
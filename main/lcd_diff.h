@@ -0,0 +1,41 @@
+/**
+ * @file lcd_diff.h
+ * @brief Word-wise dirty detection between a target and a shadow buffer.
+ *
+ * Both buffers are laid out with the same row stride, a multiple of LCD_DIFF_ALIGN,
+ * start LCD_DIFF_ALIGN-aligned and have identical padding bytes, so whole machine
+ * words (and 128-bit vectors on the ESP32-S3) can be compared without edge cases.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "lcd_frame.h"
+
+#define LCD_DIFF_ALIGN 16 /*!< row stride and buffer alignment in bytes */
+#define LCD_DIFF_MAX_ROWS 64 /*!< rows tracked by the dirty bitmask */
+
+static inline size_t lcd_diff_stride(uint8_t cols)
+{
+    return ((size_t)cols + LCD_DIFF_ALIGN - 1) & ~(size_t)(LCD_DIFF_ALIGN - 1);
+}
+
+/**
+ * @brief Append runs of cells that differ between @p target and @p shadow.
+ *
+ * Only rows whose bit is set in @p dirty are compared; clean rows cost nothing. Bits of
+ * rows found identical are cleared, bits of rows with changes stay set until a later call
+ * finds them clean (i.e. after the changes were committed to the shadow buffer).
+ *
+ * @return number of runs appended
+ */
+size_t lcd_diff(const uint8_t *target, const uint8_t *shadow, size_t stride, uint8_t cols, uint8_t rows,
+                uint64_t &dirty, std::vector<LcdRun> &runs);
+
+/**
+ * @brief Reference byte-by-byte implementation, kept for the benchmark.
+ */
+size_t lcd_diff_bytewise(const uint8_t *target, const uint8_t *shadow, size_t stride, uint8_t cols, uint8_t rows,
+                         std::vector<LcdRun> &runs);
@@ -0,0 +1,23 @@
+/**
+ * @file lcd_font_a00.h
+ * @brief The printable ASCII part of the HD44780 A00 character ROM, as 5x8 glyphs.
+ *
+ * The SerLCD's controller draws characters 0x20-0x7F from this ROM (0x5C is a yen sign,
+ * 0x7E and 0x7F are arrows). The engine needs the bitmaps to build derived glyphs, such
+ * as inverse video, in CGRAM.
+ */
+#pragma once
+
+#include "lcd_device_state.h"
+
+/**
+ * @brief Glyph of ROM character @p c.
+ * @return false for characters without embedded font data
+ */
+bool lcd_font_a00(uint8_t c, LcdGlyph &glyph);
+
+/**
+ * @brief Glyph of ROM character @p c with every pixel flipped, cursor row included.
+ * @return false for characters without embedded font data
+ */
+bool lcd_font_a00_inverse(uint8_t c, LcdGlyph &glyph);
@@ -0,0 +1,306 @@
+#include <string.h>
+#include <new>
+
+#include "lcd_frame.h"
+#include "lcd_diff.h"
+
+void LcdFrame::AlignedFree::operator()(uint8_t *p) const
+{
+    ::operator delete[](p, std::align_val_t(LCD_DIFF_ALIGN));
+}
+
+static uint8_t *aligned_buffer(size_t size)
+{
+    uint8_t *p = static_cast<uint8_t *>(::operator new[](size, std::align_val_t(LCD_DIFF_ALIGN)));
+    memset(p, 0, size); // padding must match in both buffers
+    return p;
+}
+
+LcdFrame::LcdFrame(uint8_t cols, uint8_t rows)
+    : _cols(cols), _rows(rows < LCD_DIFF_MAX_ROWS ? rows : LCD_DIFF_MAX_ROWS), _stride(lcd_diff_stride(cols)), _dirty(0), _attr_rows(0), _blink_rows(0),
+      _target(aligned_buffer(_stride * _rows)), _shadow(aligned_buffer(_stride * _rows))
+{
+    clear();
+    invalidate();
+}
+
+/**
+ * @brief Bytes the SerLCD firmware would swallow as command prefixes cannot be shown as text.
+ */
+uint8_t LcdFrame::sanitize(uint8_t c)
+{
+    return (c == LCD_CMD_SETTING || c == LCD_CMD_SPECIAL) ? '?' : c;
+}
+
+void LcdFrame::clear()
+{
+    for (uint8_t row = 0; row < _rows; row++) {
+        memset(&_target[row * _stride], ' ', _cols);
+        touch(row);
+    }
+}
+
+void LcdFrame::put_char(uint8_t col, uint8_t row, uint8_t c)
+{
+    if (col >= _cols || row >= _rows) return;
+    _target[row * _stride + col] = sanitize(c);
+    touch(row);
+}
+
+uint8_t LcdFrame::put(uint8_t col, uint8_t row, const char *text)
+{
+    if (row >= _rows) return 0;
+    uint8_t written = 0;
+    for (; col < _cols && *text; col++, text++, written++) {
+        _target[row * _stride + col] = sanitize((uint8_t)*text);
+    }
+    if (written) touch(row);
+    return written;
+}
+
+void LcdFrame::put_cells(uint8_t col, uint8_t row, const uint8_t *cells, uint8_t len)
+{
+    if (col >= _cols || row >= _rows) return;
+    if (len > _cols - col) len = _cols - col;
+    uint8_t *dst = &_target[row * _stride + col];
+    if (memcmp(dst, cells, len) == 0) return; // keep the row clean for the diff
+    memcpy(dst, cells, len);
+    touch(row);
+}
+
+void LcdFrame::invalidate()
+{
+    for (uint8_t row = 0; row < _rows; row++) {
+        memset(&_shadow[row * _stride], LCD_SHADOW_UNKNOWN, _cols);
+        touch(row);
+    }
+}
+
+void LcdFrame::assume_blank()
+{
+    for (uint8_t row = 0; row < _rows; row++) {
+        memset(&_shadow[row * _stride], ' ', _cols);
+        touch(row);
+    }
+}
+
+void LcdFrame::save_shadow(uint8_t *cells) const
+{
+    for (uint8_t row = 0; row < _rows; row++) {
+        memcpy(cells + (size_t)row * _cols, &_shadow[row * _stride], _cols);
+    }
+}
+
+void LcdFrame::restore(const uint8_t *cells)
+{
+    for (uint8_t row = 0; row < _rows; row++) {
+        uint8_t *target = &_target[row * _stride];
+        memcpy(&_shadow[row * _stride], cells + (size_t)row * _cols, _cols);
+        memcpy(target, cells + (size_t)row * _cols, _cols);
+        for (uint8_t col = 0; col < _cols; col++) {
+            // never a target cell: 0xFE on the wire is the command prefix. Stays unknown, so blanked
+            if (target[col] == LCD_SHADOW_UNKNOWN) target[col] = ' ';
+        }
+        if (_display) memcpy(&_display[row * _stride], target, _cols);
+        touch(row);
+    }
+}
+
+size_t LcdFrame::diff(std::vector<LcdRun> &runs)
+{
+    const uint8_t *target = _display ? _display.get() : _target.get();
+    return lcd_diff(target, _shadow.get(), _stride, _cols, _rows, _dirty, runs);
+}
+
+void LcdFrame::set_attr(uint8_t col, uint8_t row, uint8_t len, uint8_t attr)
+{
+    if (col >= _cols || row >= _rows) return;
+    if (len > _cols - col) len = _cols - col;
+    uint8_t attrs[256];
+    memset(attrs, attr, len);
+    put_attrs(col, row, attrs, len);
+}
+
+void LcdFrame::put_attrs(uint8_t col, uint8_t row, const uint8_t *attrs, uint8_t len)
+{
+    if (col >= _cols || row >= _rows) return;
+    if (len > _cols - col) len = _cols - col;
+    if (!_attr) {
+        bool any = false;
+        for (uint8_t i = 0; i < len; i++) any |= attrs[i] != 0;
+        if (!any) return; // stay on the plain path
+        _attr.reset(aligned_buffer(_stride * _rows));
+        _display.reset(aligned_buffer(_stride * _rows));
+        for (uint8_t r = 0; r < _rows; r++) {
+            memcpy(&_display[r * _stride], &_target[r * _stride], _cols);
+        }
+    }
+    uint8_t *dst = &_attr[row * _stride];
+    if (memcmp(dst + col, attrs, len) == 0) return;
+    memcpy(dst + col, attrs, len);
+    uint8_t any = 0;
+    for (uint8_t i = 0; i < _cols; i++) any |= dst[i];
+    uint64_t bit = (uint64_t)1 << row;
+    _attr_rows = any ? (_attr_rows | bit) : (_attr_rows & ~bit);
+    _blink_rows = (any & LCD_ATTR_BLINK) ? (_blink_rows | bit) : (_blink_rows & ~bit);
+    touch(row);
+}
+
+void LcdFrame::resolve(const uint8_t inverse[256], bool blink_on)
+{
+    if (!_display) return;
+    for (uint64_t pending = _dirty; pending; pending &= pending - 1) {
+        uint8_t row = (uint8_t)__builtin_ctzll(pending);
+        const uint8_t *t = &_target[row * _stride];
+        uint8_t *d = &_display[row * _stride];
+        memcpy(d, t, _cols);
+        if (!(_attr_rows & ((uint64_t)1 << row))) continue;
+
+        const uint8_t *a = &_attr[row * _stride];
+        for (uint8_t col = 0; col < _cols;) {
+            if (!(a[col] & LCD_ATTR_INVERSE)) {
+                col++;
+                continue;
+            }
+            uint8_t end = col;
+            bool mapped = true;
+            for (; end < _cols && (a[end] & LCD_ATTR_INVERSE); end++) mapped &= inverse[t[end]] != LCD_INVERSE_NONE;
+            if (mapped) {
+                for (uint8_t i = col; i < end; i++) d[i] = inverse[t[i]];
+            } else if (end - col >= 2) {
+                d[col] = '[';
+                d[end - 1] = ']';
+            }
+            col = end;
+        }
+        if (!blink_on && (_blink_rows & ((uint64_t)1 << row))) {
+            for (uint8_t col = 0; col < _cols; col++) {
+                if (a[col] & LCD_ATTR_BLINK) d[col] = ' ';
+            }
+        }
+    }
+}
+
+void LcdFrame::commit(const LcdTransaction &tx)
+{
+    const uint8_t *cells = tx.cells;
+    for (uint8_t i = 0; i < tx.nruns; i++) {
+        const LcdRun &run = tx.runs[i];
+        memcpy(&_shadow[run.row * _stride + run.col], cells, run.len);
+        cells += run.len;
+    }
+}
+
+void LcdFrame::forget(const LcdTransaction &tx)
+{
+    for (uint8_t i = 0; i < tx.nruns; i++) {
+        const LcdRun &run = tx.runs[i];
+        memset(&_shadow[run.row * _stride + run.col], LCD_SHADOW_UNKNOWN, run.len);
+        touch(run.row);
+    }
+}
+
+/**
+ * @brief HD44780 DDRAM address of a cell.
+ *
+ * Rows 0/1 start at 0x00/0x40; rows 2/3 continue those lines after the visible columns
+ * (0x14/0x54 on a 20x4, 0x10/0x50 on a 16x4). A page of a 2-line display may start
+ * further along the line (see LcdPanel::enable_pages()).
+ */
+uint8_t LcdFrame::ddram_address(uint8_t col, uint8_t row) const
+{
+    return (uint8_t)(((row & 1) ? 0x40 : 0x00) + ((row >= 2) ? _cols : 0) + _ddram_offset + col);
+}
+
+static inline uint8_t cell_cost(uint8_t c)
+{
+    return c < 8 ? 2 : 1; // CGRAM characters go through the '|' custom character command
+}
+
+static LcdTransaction &new_transaction(std::vector<LcdTransaction> &out, void *owner, uint8_t addr)
+{
+    out.emplace_back();
+    LcdTransaction &tx = out.back();
+    tx.owner = owner;
+    tx.addr = addr;
+    tx.len = 0;
+    tx.nruns = 0;
+    tx.ncells = 0;
+    tx.settle_ms = 0;
+    tx.known = 0;
+    tx.cgram = 0;
+    tx.back = false;
+    tx.clears = false;
+    tx.assumed = false;
+    tx.timeout_ms = LCD_TIMEOUT_FIELD_MS;
+    tx.deadline_us = 0;
+    return tx;
+}
+
+void lcd_command_transaction(LcdTransaction &tx, void *owner, uint8_t addr, const uint8_t *bytes, uint8_t len,
+                             uint16_t settle_ms, uint8_t known, uint16_t timeout_ms)
+{
+    tx.owner = owner;
+    tx.addr = addr;
+    tx.len = len < LCD_TX_MAX_BYTES ? len : LCD_TX_MAX_BYTES;
+    tx.nruns = 0;
+    tx.ncells = 0;
+    tx.settle_ms = settle_ms;
+    tx.known = known;
+    tx.cgram = 0;
+    tx.back = false;
+    tx.clears = false;
+    tx.assumed = false;
+    tx.timeout_ms = timeout_ms;
+    tx.deadline_us = 0;
+    memcpy(tx.bytes, bytes, tx.len);
+}
+
+size_t lcd_encode(const LcdFrame &frame, const std::vector<LcdRun> &runs, void *owner, uint8_t addr,
+                  std::vector<LcdTransaction> &out)
+{
+    size_t before = out.size();
+    LcdTransaction *tx = nullptr;
+    int cursor = -1; // DDRAM address of the device cursor, -1 when unknown
+
+    for (size_t i = 0; i < runs.size(); i++) {
+        LcdRun run = runs[i];
+        // merge close neighbours on the same row
+        while (i + 1 < runs.size() && runs[i + 1].row == run.row && runs[i + 1].col - (run.col + run.len) <= 2) {
+            run.len = (uint8_t)(runs[i + 1].col + runs[i + 1].len - run.col);
+            i++;
+        }
+
+        const uint8_t *t = frame.display_row(run.row);
+        for (uint8_t col = run.col; col < run.col + run.len; col++) {
+            uint8_t c = t[col];
+            uint8_t address = frame.ddram_address(col, run.row);
+            bool move = cursor != address;
+            uint8_t need = (uint8_t)((move ? 2 : 0) + cell_cost(c));
+
+            bool open = tx && tx->nruns > 0 && !move && tx->runs[tx->nruns - 1].row == run.row &&
+                        tx->runs[tx->nruns - 1].col + tx->runs[tx->nruns - 1].len == col;
+            if (!tx || tx->len + need > LCD_TX_MAX_BYTES || (!open && tx->nruns == LCD_TX_MAX_RUNS)) {
+                tx = &new_transaction(out, owner, addr);
+                open = false;
+            }
+            if (move) {
+                tx->bytes[tx->len++] = LCD_CMD_SPECIAL;
+                tx->bytes[tx->len++] = LCD_CMD_DDRAM | address;
+            }
+            if (!open) {
+                tx->runs[tx->nruns++] = {run.row, col, 0};
+            }
+            if (c < 8) {
+                tx->bytes[tx->len++] = LCD_CMD_SETTING;
+                tx->bytes[tx->len++] = LCD_CMD_CUSTOM_CHAR + c;
+            } else {
+                tx->bytes[tx->len++] = c;
+            }
+            tx->runs[tx->nruns - 1].len++;
+            tx->cells[tx->ncells++] = c;
+            cursor = (col + 1 < frame.cols()) ? address + 1 : -1; // the firmware wraps at the row end
+        }
+    }
+    return out.size() - before;
+}
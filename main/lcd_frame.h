@@ -0,0 +1,176 @@
+/**
+ * @file lcd_frame.h
+ * @brief Shadow/target frame buffers and the SerLCD byte-stream encoder.
+ *
+ * The application draws into the target buffer. The shadow buffer holds what the
+ * device is known to show. A frame is the diff between the two, encoded into
+ * transactions that each fit in one I2C write to the SerLCD.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#define LCD_CMD_SETTING      0x7C /*!< SerLCD settings prefix ('|') */
+#define LCD_CMD_SPECIAL      0xFE /*!< SerLCD prefix for a raw HD44780 command */
+#define LCD_CMD_DDRAM        0x80 /*!< HD44780 set DDRAM address */
+#define LCD_CMD_HOME         0x02 /*!< HD44780 return home: address 0, display shift undone */
+#define LCD_CMD_SHIFT_LEFT   0x18 /*!< HD44780 shift the display one column left */
+#define LCD_DDRAM_LINE       40   /*!< DDRAM columns per line in 2-line mode */
+#define LCD_CMD_CUSTOM_CHAR  35   /*!< '|' + 35 + n writes CGRAM character n */
+#define LCD_SETTING_CLEAR    0x2D /*!< '|' '-' clears the display and homes the cursor */
+#define LCD_SETTING_CREATE_CHAR 27 /*!< '|' 27 + n, 8 rows: load CGRAM slot n, EEPROM */
+
+#define LCD_TX_MAX_BYTES     32   /*!< SerLCD (ATmega TWI) receive buffer size */
+#define LCD_TX_MAX_RUNS      10   /*!< a run costs at least 3 bytes, so at most 10 per transaction */
+
+#define LCD_SHADOW_UNKNOWN   0xFE /*!< shadow value that never matches a target cell */
+
+#define LCD_ATTR_INVERSE     0x01 /*!< cell attribute: light on dark, see LcdFrame::resolve() */
+#define LCD_ATTR_BLINK       0x02 /*!< cell attribute: blanked in the off phase, see LcdPanel::blink_ms */
+#define LCD_INVERSE_NONE     0xFE /*!< LcdFrame::resolve() map entry: no inverse glyph */
+
+// Per-operation timeout budgets, on top of the time the bytes take on the wire
+#define LCD_TIMEOUT_FIELD_MS    5   /*!< cell updates */
+#define LCD_TIMEOUT_COMMAND_MS  10  /*!< commands the firmware handles in RAM */
+#define LCD_TIMEOUT_EEPROM_MS   100 /*!< settings the firmware stores in EEPROM */
+#define LCD_FRAME_BUDGET_MS     100 /*!< default time a frame may take before the rest is cancelled */
+
+/**
+ * @brief A horizontal run of changed cells.
+ */
+struct LcdRun {
+    uint8_t row;
+    uint8_t col;
+    uint8_t len;
+};
+
+/**
+ * @brief One I2C write to a display, plus what it changes on the device.
+ */
+struct LcdTransaction {
+    void *owner;                          /*!< panel that produced the transaction */
+    uint8_t addr;                         /*!< 7-bit I2C address of the display */
+    uint8_t len;                          /*!< used bytes in bytes[] */
+    uint8_t nruns;                        /*!< used entries in runs[] */
+    uint8_t ncells;                       /*!< used entries in cells[] */
+    uint16_t settle_ms;                   /*!< time the firmware needs after this write */
+    uint8_t known;                        /*!< LCD_KNOWN_* settings this write changes; unknown again if it fails */
+    uint8_t cgram;                        /*!< bit per CGRAM slot this write loads; unknown again if it fails */
+    bool back;                            /*!< cells belong to the panel's back page */
+    bool clears;                          /*!< clears the display; its frame was assumed blank when planned */
+    bool assumed;                         /*!< cells were committed to the shadow when planned; forgotten unless sent */
+    uint16_t timeout_ms;                  /*!< budget for this write beyond its wire time */
+    int64_t deadline_us;                  /*!< frame deadline (lcd_now_us()), 0 for none */
+    uint8_t bytes[LCD_TX_MAX_BYTES];      /*!< wire bytes */
+    LcdRun runs[LCD_TX_MAX_RUNS];         /*!< cells written, for the shadow commit */
+    uint8_t cells[LCD_TX_MAX_BYTES];      /*!< cell values of runs[], back to back */
+};
+
+/**
+ * @brief A cell transaction encoded ahead of time, e.g. at build time, for a blank display.
+ *
+ * Fixed size and without pointers, so tables of them can be used in place from flash.
+ * The cell values are not stored; they are the cells of the screen the runs belong to.
+ */
+struct LcdEncodedTx {
+    uint8_t len;                     /*!< used bytes in bytes[] */
+    uint8_t nruns;                   /*!< used entries in runs[] */
+    uint16_t settle_ms;
+    uint8_t bytes[LCD_TX_MAX_BYTES];
+    LcdRun runs[LCD_TX_MAX_RUNS];
+};
+
+class LcdFrame {
+public:
+    LcdFrame(uint8_t cols = 20, uint8_t rows = 4);
+
+    uint8_t cols() const { return _cols; }
+    uint8_t rows() const { return _rows; }
+
+    void clear(); // target only; fills with spaces
+    void put_char(uint8_t col, uint8_t row, uint8_t c);
+    uint8_t put(uint8_t col, uint8_t row, const char *text); // clipped to the row, returns cells written
+    void put_cells(uint8_t col, uint8_t row, const uint8_t *cells, uint8_t len); // already sanitized
+
+    const uint8_t *target_row(uint8_t row) const { return &_target[row * _stride]; }
+    const uint8_t *shadow_row(uint8_t row) const { return &_shadow[row * _stride]; }
+    size_t stride() const { return _stride; }
+
+    // Cell attributes. The attribute and display buffers only exist once an attribute
+    // was set; until then the target is what the device shows.
+    void set_attr(uint8_t col, uint8_t row, uint8_t len, uint8_t attr);
+    void put_attrs(uint8_t col, uint8_t row, const uint8_t *attrs, uint8_t len);
+    bool has_attributes() const { return _attr != nullptr; }
+    const uint8_t *attr_row(uint8_t row) const { return &_attr[row * _stride]; } // only with has_attributes()
+    uint64_t attr_rows() const { return _attr_rows; } // rows with any attribute set
+    uint64_t blink_rows() const { return _blink_rows; } // rows with a blinking cell
+    const uint8_t *display_row(uint8_t row) const { return _display ? &_display[row * _stride] : target_row(row); }
+
+    /**
+     * @brief Build what the device should show for the rows about to be diffed.
+     *
+     * @p inverse maps a character to the code showing it inverted (a CGRAM slot, or the
+     * ROM block for a space), or LCD_INVERSE_NONE. A span of inverse cells with a character that has no code falls back
+     * to a bracket marker on its first and last cell, so leave those blank. Blinking
+     * cells show a space while @p blink_on is false.
+     */
+    void resolve(const uint8_t inverse[256], bool blink_on);
+    void touch_attributed() { _dirty |= _attr_rows; } // the inverse mapping changed
+    void touch_blinking() { _dirty |= _blink_rows; }  // the blink phase changed
+
+    void invalidate(); // forget what the device shows; next diff covers every cell
+    void assume_blank(); // the device was just cleared
+    void save_shadow(uint8_t *cells) const; // cols * rows cells, row major
+    void restore(const uint8_t *cells);     // device shows cells; target and shadow both set, unknown cells blanked
+    size_t diff(std::vector<LcdRun> &runs); // clears the dirty bits of rows found clean
+    void commit(const LcdTransaction &tx); // a transaction reached the device
+    void forget(const LcdTransaction &tx); // a transaction failed part way; its cells are unknown; caller holds the panel lock
+
+    uint8_t ddram_address(uint8_t col, uint8_t row) const;
+    uint8_t ddram_offset() const { return _ddram_offset; }
+    void set_ddram_offset(uint8_t offset) { _ddram_offset = offset; } // first DDRAM column of a 2-line page
+
+    static uint8_t sanitize(uint8_t c);
+
+private:
+    struct AlignedFree {
+        void operator()(uint8_t *p) const;
+    };
+    typedef std::unique_ptr<uint8_t[], AlignedFree> Buffer;
+
+    void touch(uint8_t row) { _dirty |= (uint64_t)1 << row; }
+
+    uint8_t _cols;
+    uint8_t _rows;
+    uint8_t _ddram_offset = 0;
+    size_t _stride;  /*!< row pitch of both buffers, see lcd_diff.h */
+    uint64_t _dirty; /*!< rows whose target may differ from the shadow */
+    uint64_t _attr_rows; /*!< rows with any attribute */
+    uint64_t _blink_rows; /*!< rows with LCD_ATTR_BLINK cells */
+    Buffer _target;
+    Buffer _shadow;
+    Buffer _attr;    /*!< LCD_ATTR_* per target cell; null until first used */
+    Buffer _display; /*!< target with attributes applied; null until first used */
+};
+
+/**
+ * @brief Fill @p tx with a command that does not write cells (settings, display control).
+ */
+void lcd_command_transaction(LcdTransaction &tx, void *owner, uint8_t addr, const uint8_t *bytes, uint8_t len,
+                             uint16_t settle_ms, uint8_t known, uint16_t timeout_ms);
+
+/**
+ * @brief Encode runs of a frame into as few transactions as possible.
+ *
+ * Runs on the same row separated by a gap of two cells or less are merged by
+ * resending the unchanged cells, which is never more bytes than a cursor move.
+ * The cursor is only assumed to continue along a row; the SerLCD firmware applies
+ * its own line wrapping, so a new row always gets an explicit DDRAM address.
+ *
+ * @return number of transactions appended to @p out
+ */
+size_t lcd_encode(const LcdFrame &frame, const std::vector<LcdRun> &runs, void *owner, uint8_t addr,
+                  std::vector<LcdTransaction> &out);
@@ -0,0 +1,59 @@
+/**
+ * @file lcd_glyph.h
+ * @brief Glyphs from ASCII art, encoded at compile time.
+ *
+ *     static constexpr LcdGlyph bell = lcd_glyph(
+ *         "..#.."
+ *         ".###."
+ *         ".###."
+ *         ".###."
+ *         "#####"
+ *         "....."
+ *         "..#.."
+ *         ".....");
+ *
+ * Each row is 5 characters, '#' for a lit pixel and '.' for a dark one; any other
+ * character or a wrong length fails the build. Packs are plain constexpr LcdGlyph
+ * arrays, so they live in flash and go straight to LcdSettings::load_glyphs().
+ */
+#pragma once
+
+#include <stddef.h>
+
+#include "lcd_device_state.h"
+
+#define LCD_GLYPH_COLS 5
+
+// Not constexpr: reaching it during constant evaluation is a compile error naming the cause
+void lcd_glyph_art_must_be_5x8_of_hash_and_dot();
+
+template <size_t N>
+consteval LcdGlyph lcd_glyph(const char (&art)[N])
+{
+    if (N != LCD_GLYPH_COLS * LCD_GLYPH_ROWS + 1) lcd_glyph_art_must_be_5x8_of_hash_and_dot();
+    LcdGlyph glyph = {};
+    for (size_t row = 0; row < LCD_GLYPH_ROWS; row++) {
+        uint8_t bits = 0;
+        for (size_t col = 0; col < LCD_GLYPH_COLS; col++) {
+            char c = art[row * LCD_GLYPH_COLS + col];
+            if (c != '#' && c != '.') lcd_glyph_art_must_be_5x8_of_hash_and_dot();
+            bits = (uint8_t)(bits << 1 | (c == '#'));
+        }
+        glyph.rows[row] = bits;
+    }
+    return glyph;
+}
+
+/**
+ * @brief True if no two glyphs of @p pack are the same, for a static_assert on a pack.
+ */
+template <size_t N>
+constexpr bool lcd_glyphs_distinct(const LcdGlyph (&pack)[N])
+{
+    for (size_t a = 0; a < N; a++) {
+        for (size_t b = a + 1; b < N; b++) {
+            if (pack[a] == pack[b]) return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,145 @@
+#include <string.h>
+
+#include "lcd_layout.h"
+#include "lcd_screen.h"
+
+static const char *TAG = "lcd_layout";
+
+#ifdef ESP_PLATFORM
+esp_err_t LcdLayout::open(const char *label)
+{
+    close();
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (!part) return ESP_ERR_NOT_FOUND;
+    const void *image;
+    esp_err_t err = esp_partition_mmap(part, 0, part->size, ESP_PARTITION_MMAP_DATA, &image, &_mmap);
+    if (err != ESP_OK) return err;
+    _mapped = true;
+    err = open(image, part->size);
+    if (err != ESP_OK) close();
+    return err;
+}
+#endif
+
+esp_err_t LcdLayout::open(const void *image, size_t size)
+{
+    _base = (const uint8_t *)image;
+    _size = size;
+    esp_err_t err = check();
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "unusable layout image: %d", err);
+        _base = nullptr;
+        _size = 0;
+    }
+    return err;
+}
+
+void LcdLayout::close()
+{
+#ifdef ESP_PLATFORM
+    if (_mapped) esp_partition_munmap(_mmap);
+    _mapped = false;
+#endif
+    _base = nullptr;
+    _size = 0;
+}
+
+bool LcdLayout::contains(uint32_t offset, size_t count, size_t size, size_t align) const
+{
+    size_t image = header()->size;
+    return offset % align == 0 && offset <= image && count <= (image - offset) / size;
+}
+
+/**
+ * @brief Bounds of everything the accessors and show() will touch, once at open().
+ */
+esp_err_t LcdLayout::check() const
+{
+    if (_size < sizeof(LcdLayoutHeader)) return ESP_ERR_INVALID_SIZE;
+    const LcdLayoutHeader *h = header();
+    if (h->magic != LCD_LAYOUT_MAGIC) return ESP_ERR_NOT_FOUND; // an erased partition
+    if (h->version != LCD_LAYOUT_VERSION) return ESP_ERR_INVALID_VERSION;
+    if (h->size > _size || h->cols == 0 || h->rows == 0) return ESP_ERR_INVALID_SIZE;
+    const size_t cells = (size_t)h->cols * h->rows;
+    if (!contains(h->glyphs, h->glyph_count, sizeof(LcdGlyph), 1) ||
+        !contains(h->screens, h->screen_count, sizeof(LcdLayoutScreen), 4)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    for (uint16_t i = 0; i < h->screen_count; i++) {
+        const LcdLayoutScreen &s = at<LcdLayoutScreen>(h->screens)[i];
+        if (!contains(s.cells, cells, 1, 1) || !contains(s.tx, s.tx_count, sizeof(LcdEncodedTx), 2) ||
+            !contains(s.fields, s.field_count, sizeof(LcdLayoutField), 1) ||
+            !contains(s.widgets, s.widget_count, sizeof(LcdLayoutWidget), 1)) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        for (uint8_t slot = 0; slot < LCD_CGRAM_SLOTS; slot++) {
+            if (s.glyphs[slot] != LCD_GLYPH_NONE && s.glyphs[slot] >= h->glyph_count) return ESP_ERR_INVALID_SIZE;
+        }
+        for (uint16_t t = 0; t < s.tx_count; t++) {
+            const LcdEncodedTx &tx = at<LcdEncodedTx>(s.tx)[t];
+            if (tx.len > LCD_TX_MAX_BYTES || tx.nruns > LCD_TX_MAX_RUNS) return ESP_ERR_INVALID_SIZE;
+            size_t run_cells = 0;
+            for (uint8_t r = 0; r < tx.nruns; r++) {
+                const LcdRun &run = tx.runs[r];
+                if (run.row >= h->rows || run.col + run.len > h->cols) return ESP_ERR_INVALID_SIZE;
+                run_cells += run.len;
+            }
+            if (run_cells > LCD_TX_MAX_BYTES) return ESP_ERR_INVALID_SIZE;
+        }
+        for (uint8_t f = 0; f < s.field_count; f++) {
+            const LcdLayoutField &field = at<LcdLayoutField>(s.fields)[f];
+            if (field.row >= h->rows || field.col + field.width > h->cols) return ESP_ERR_INVALID_SIZE;
+        }
+        for (uint8_t w = 0; w < s.widget_count; w++) {
+            const LcdLayoutWidget &widget = at<LcdLayoutWidget>(s.widgets)[w];
+            if (widget.row + widget.height > h->rows || widget.col + widget.width > h->cols) return ESP_ERR_INVALID_SIZE;
+        }
+    }
+    return ESP_OK;
+}
+
+const LcdLayoutScreen *LcdLayout::screen(const char *name) const
+{
+    if (!_base) return nullptr;
+    const LcdLayoutScreen *screens = at<LcdLayoutScreen>(header()->screens);
+    for (uint16_t i = 0; i < header()->screen_count; i++) {
+        if (strncmp(screens[i].name, name, sizeof(screens[i].name)) == 0) return &screens[i];
+    }
+    return nullptr;
+}
+
+const LcdLayoutField *LcdLayout::field(const LcdLayoutScreen *screen, const char *name) const
+{
+    const LcdLayoutField *fields = at<LcdLayoutField>(screen->fields);
+    for (uint8_t i = 0; i < screen->field_count; i++) {
+        if (strncmp(fields[i].name, name, LCD_LAYOUT_NAME) == 0) return &fields[i];
+    }
+    return nullptr;
+}
+
+const LcdLayoutWidget *LcdLayout::widget(const LcdLayoutScreen *screen, const char *name) const
+{
+    const LcdLayoutWidget *widgets = at<LcdLayoutWidget>(screen->widgets);
+    for (uint8_t i = 0; i < screen->widget_count; i++) {
+        if (strncmp(widgets[i].name, name, LCD_LAYOUT_NAME) == 0) return &widgets[i];
+    }
+    return nullptr;
+}
+
+esp_err_t LcdLayout::show(LcdPanel &panel, LcdSettings &settings, const LcdLayoutScreen *screen) const
+{
+    if (panel.frame.cols() != header()->cols || panel.frame.rows() != header()->rows) return ESP_ERR_INVALID_SIZE;
+    settings.load_glyph_page(at<LcdGlyph>(header()->glyphs), screen->glyphs);
+    std::lock_guard<std::mutex> guard(panel.lock);
+    return panel.show_encoded(at<LcdEncodedTx>(screen->tx), screen->tx_count, at<uint8_t>(screen->cells));
+}
+
+void LcdLayout::set_field(LcdPanel &panel, const LcdLayoutField *field, const char *text) const
+{
+    lcd_put_field(panel, field->col, field->row, field->width, field->align, text);
+}
+
+LcdRegion *LcdLayout::lease(LcdPanel &panel, const LcdLayoutWidget *widget) const
+{
+    return panel.lease(widget->col, widget->row, widget->width, widget->height);
+}
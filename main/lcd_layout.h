@@ -0,0 +1,146 @@
+/**
+ * @file lcd_layout.h
+ * @brief Screen layouts read in place from a memory-mapped flash partition.
+ *
+ * A layout image holds, per screen, the static text as the cells it shows and as
+ * transactions encoded for a blank display, named field slots, the CGRAM glyphs the
+ * text uses and named widget rectangles. tools/layout_gen builds the image from a text
+ * description and checks it on the emulator; changing a layout then means rewriting a
+ * data partition instead of reflashing the firmware:
+ *
+ *     # partitions.csv
+ *     lcd_layout, data, 0x40, , 16K
+ *
+ *     parttool.py write_partition --partition-name lcd_layout --input layout.bin
+ *
+ * Nothing is parsed into RAM. open() maps the partition and checks the offsets and
+ * sizes once; after that every accessor returns a pointer into the mapping, and show()
+ * hands the encoded transactions and cells to LcdPanel::show_encoded() as they are.
+ *
+ * All structures are little-endian with natural alignment, as the ESP32 and the host
+ * tool lay them out.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lcd_panel.h"
+#include "lcd_settings.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_partition.h"
+#endif
+
+#define LCD_LAYOUT_MAGIC   0x4C44434C /*!< "LCDL" */
+#define LCD_LAYOUT_VERSION 1
+#define LCD_LAYOUT_NAME    12 /*!< name bytes of fields and widgets, NUL padded */
+
+#define LCD_LAYOUT_ALIGN_LEFT  0
+#define LCD_LAYOUT_ALIGN_RIGHT 1
+
+#define LCD_LAYOUT_WIDGET_TEXT     1 /*!< LcdTextLayout */
+#define LCD_LAYOUT_WIDGET_PROGRESS 2 /*!< LcdProgressBar */
+#define LCD_LAYOUT_WIDGET_CLOCK    3 /*!< LcdClockWidget */
+
+struct LcdLayoutHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t screen_count;
+    uint32_t size;        /*!< bytes in the image */
+    uint8_t cols;
+    uint8_t rows;
+    uint8_t glyph_count;
+    uint8_t reserved;
+    uint32_t glyphs;      /*!< offset of LcdGlyph[glyph_count] */
+    uint32_t screens;     /*!< offset of LcdLayoutScreen[screen_count] */
+};
+
+struct LcdLayoutScreen {
+    char name[16];
+    uint32_t cells;        /*!< offset of cols * rows static cells, row major; fields are blank */
+    uint32_t tx;           /*!< offset of LcdEncodedTx[tx_count] that draw cells on a blank display */
+    uint32_t fields;       /*!< offset of LcdLayoutField[field_count] */
+    uint32_t widgets;      /*!< offset of LcdLayoutWidget[widget_count] */
+    uint16_t tx_count;
+    uint8_t field_count;
+    uint8_t widget_count;
+    uint8_t glyphs[LCD_CGRAM_SLOTS]; /*!< glyph index per CGRAM slot, LCD_GLYPH_NONE if unused */
+};
+
+struct LcdLayoutField {
+    char name[LCD_LAYOUT_NAME];
+    uint8_t col;
+    uint8_t row;
+    uint8_t width;
+    uint8_t align; /*!< LCD_LAYOUT_ALIGN_* */
+};
+
+struct LcdLayoutWidget {
+    char name[LCD_LAYOUT_NAME];
+    uint8_t type; /*!< LCD_LAYOUT_WIDGET_* */
+    uint8_t col;
+    uint8_t row;
+    uint8_t width;
+    uint8_t height;
+    uint8_t reserved[3];
+};
+
+static_assert(sizeof(LcdLayoutHeader) == 24, "layout image format");
+static_assert(sizeof(LcdLayoutScreen) == 44, "layout image format");
+static_assert(sizeof(LcdLayoutField) == 16, "layout image format");
+static_assert(sizeof(LcdLayoutWidget) == 20, "layout image format");
+static_assert(sizeof(LcdEncodedTx) == 66, "layout image format");
+
+class LcdLayout {
+public:
+    ~LcdLayout() { close(); }
+
+#ifdef ESP_PLATFORM
+    /**
+     * @brief Map the data partition labelled @p label and check the image in it.
+     * @return ESP_ERR_NOT_FOUND without such a partition, ESP_ERR_INVALID_VERSION or
+     *         ESP_ERR_INVALID_SIZE for an image this build cannot use
+     */
+    esp_err_t open(const char *label);
+#endif
+    /**
+     * @brief Use an image that is already addressable, e.g. embedded or on the host.
+     */
+    esp_err_t open(const void *image, size_t size);
+    void close();
+
+    const LcdLayoutHeader *header() const { return (const LcdLayoutHeader *)_base; }
+    const LcdLayoutScreen *screen(const char *name) const; // nullptr if not found
+    const LcdLayoutField *field(const LcdLayoutScreen *screen, const char *name) const;
+    const LcdLayoutWidget *widget(const LcdLayoutScreen *screen, const char *name) const;
+
+    /**
+     * @brief Switch @p panel to @p screen: load its glyphs, then its static content
+     *        with the next frame. Fields start blank.
+     * @return ESP_ERR_INVALID_SIZE if the image was made for another display size
+     */
+    esp_err_t show(LcdPanel &panel, LcdSettings &settings, const LcdLayoutScreen *screen) const;
+
+    /**
+     * @brief Draw @p text into @p field, aligned and padded to its width. Takes panel.lock.
+     */
+    void set_field(LcdPanel &panel, const LcdLayoutField *field, const char *text) const;
+
+    /**
+     * @brief Lease the rectangle of @p widget for the application's widget object.
+     */
+    LcdRegion *lease(LcdPanel &panel, const LcdLayoutWidget *widget) const;
+
+private:
+    template <typename T> const T *at(uint32_t offset) const { return (const T *)(_base + offset); }
+    bool contains(uint32_t offset, size_t count, size_t size, size_t align) const;
+    esp_err_t check() const;
+
+    const uint8_t *_base = nullptr;
+    size_t _size = 0;
+#ifdef ESP_PLATFORM
+    esp_partition_mmap_handle_t _mmap;
+    bool _mapped = false;
+#endif
+};
@@ -0,0 +1,412 @@
+#include <string.h>
+
+#include "lcd_panel.h"
+#include "lcd_font_a00.h"
+#include "lcd_settings.h"
+
+LcdPanel::LcdPanel(uint8_t addr, uint8_t port, uint8_t cols, uint8_t rows)
+    : frame(cols, rows), addr(addr), port(port), device(), _suspended(false), _critical_changed(false), _resync(false), _pending(0),
+      _failed(false)
+{
+    device.forget();
+    memset(_inverse, LCD_INVERSE_NONE, sizeof(_inverse));
+}
+
+size_t LcdPanel::plan(std::vector<LcdRun> &runs, std::vector<LcdTransaction> &out)
+{
+    if (!idle()) return 0;
+    runs.clear();
+    size_t first = out.size();
+    int64_t now = lcd_now_us();
+
+    if (health.state() == LCD_HEALTH_OFFLINE) {
+        // keep commands and cells for later; only knock
+        if (health.probe_due(now)) {
+            out.emplace_back();
+            lcd_command_transaction(out.back(), this, addr, nullptr, 0, 0, 0, LCD_TIMEOUT_COMMAND_MS);
+        }
+        return out.size() - first;
+    }
+    if (!health.frame_due(now)) return 0;
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (_resync.exchange(false)) {
+            const uint8_t clear[] = {LCD_CMD_SETTING, LCD_SETTING_CLEAR};
+            out.emplace_back();
+            lcd_command_transaction(out.back(), this, addr, clear, sizeof(clear), 10, 0, LCD_TIMEOUT_COMMAND_MS);
+            out.back().clears = true; // planned as done, so the diff below redraws everything; retried if not
+            frame.assume_blank();
+            if (_back) _back->assume_blank();
+            device.shift = 0; // clear also undoes the display shift
+            device.known |= LCD_KNOWN_SHIFT;
+        }
+        if (_flip) {
+            if (_back) {
+                std::swap(frame, *_back);
+                // regions and bindings only merge what they changed; put all of them on the new front page
+                for (auto &region : _regions) region->invalidate();
+                for (auto &binding : _bindings) binding.invalidate();
+            }
+            _flip = false;
+        }
+        bool suspended = _suspended.load(std::memory_order_relaxed);
+        if (suspended) {
+            for (auto &region : _regions) {
+                if (!region->critical()) continue;
+                if (region->dirty()) _critical_changed.store(true, std::memory_order_relaxed);
+                region->merge(frame);
+            }
+        } else {
+            for (auto &region : _regions) region->merge(frame);
+            for (auto &binding : _bindings) binding.sample(frame);
+            if (frame.has_attributes()) resolve_attributes(now); // may queue CGRAM loads for this frame
+        }
+
+        LcdSettings::restore(*this);
+        out.insert(out.end(), _commands.begin(), _commands.end());
+        _commands.clear();
+        if (_encoded && !suspended) send_encoded(out); // after the commands: they may load its glyphs
+        if (_redraw) {
+            frame.invalidate();
+            _redraw = false;
+        }
+        if (_back) sync_shift(out);
+        if (!suspended && frame.diff(runs)) lcd_encode(frame, runs, this, addr, out);
+
+        if (_back && !suspended && out.size() == first) {
+            // nothing else to send: preload the back page
+            runs.clear();
+            size_t before = out.size();
+            if (_back->diff(runs)) lcd_encode(*_back, runs, this, addr, out);
+            for (size_t i = before; i < out.size(); i++) out[i].back = true;
+            _back_clean = out.size() == before;
+        }
+    }
+
+    if (frame_budget_ms) {
+        // settle times are waits the frame asked for, not slowness
+        int64_t deadline = now + (int64_t)frame_budget_ms * 1000;
+        for (size_t i = first; i < out.size(); i++) deadline += (int64_t)out[i].settle_ms * 1000;
+        for (size_t i = first; i < out.size(); i++) out[i].deadline_us = deadline;
+    }
+    return out.size() - first;
+}
+
+esp_err_t LcdPanel::show_encoded(const LcdEncodedTx *tx, size_t count, const uint8_t *cells)
+{
+    if (_back) return ESP_ERR_INVALID_STATE;
+    for (uint8_t row = 0; row < frame.rows(); row++) frame.put_cells(0, row, &cells[row * frame.cols()], frame.cols());
+    _encoded = tx;
+    _encoded_count = count;
+    _encoded_cells = cells;
+    return ESP_OK;
+}
+
+void LcdPanel::send_encoded(std::vector<LcdTransaction> &out)
+{
+    const uint8_t clear[] = {LCD_CMD_SETTING, LCD_SETTING_CLEAR};
+    out.emplace_back();
+    lcd_command_transaction(out.back(), this, addr, clear, sizeof(clear), 10, 0, LCD_TIMEOUT_COMMAND_MS);
+    out.back().clears = true;
+    frame.assume_blank();
+    for (size_t i = 0; i < _encoded_count; i++) {
+        const LcdEncodedTx &enc = _encoded[i];
+        out.emplace_back();
+        LcdTransaction &tx = out.back();
+        lcd_command_transaction(tx, this, addr, enc.bytes, enc.len, enc.settle_ms, 0, LCD_TIMEOUT_FIELD_MS);
+        for (uint8_t r = 0; r < enc.nruns; r++) {
+            const LcdRun &run = enc.runs[r];
+            tx.runs[tx.nruns++] = run;
+            memcpy(&tx.cells[tx.ncells], &_encoded_cells[run.row * frame.cols() + run.col], run.len);
+            tx.ncells += run.len;
+        }
+        // ahead of complete() so the diff below leaves these cells alone; complete()
+        // forgets them again if the write fails, is skipped or is cancelled
+        frame.commit(tx);
+        tx.assumed = true;
+    }
+    _encoded = nullptr;
+}
+
+void LcdPanel::send(const uint8_t *bytes, uint8_t len, uint16_t settle_ms, uint8_t known, uint16_t timeout_ms,
+                    uint8_t cgram)
+{
+    _commands.emplace_back();
+    lcd_command_transaction(_commands.back(), this, addr, bytes, len, settle_ms, known, timeout_ms);
+    _commands.back().cgram = cgram;
+}
+
+size_t LcdPanel::load_cgram(const LcdGlyph *const slots[LCD_CGRAM_SLOTS], bool wanted)
+{
+    uint8_t cmd[LCD_TX_MAX_BYTES];
+    uint8_t len = 0;
+    uint8_t loading = 0; // slots loaded by cmd
+    size_t loaded = 0;
+    for (uint8_t slot = 0; slot < LCD_CGRAM_SLOTS; slot++) {
+        if (!slots[slot]) continue;
+        uint8_t bit = (uint8_t)(1 << slot);
+        device.cgram_wanted = wanted ? (uint8_t)(device.cgram_wanted | bit) : (uint8_t)(device.cgram_wanted & ~bit);
+        uint8_t rows[LCD_GLYPH_ROWS];
+        for (int r = 0; r < LCD_GLYPH_ROWS; r++) rows[r] = slots[slot]->rows[r] & 0x1F;
+        if ((device.cgram_known & bit) && memcmp(device.cgram[slot], rows, sizeof(rows)) == 0) continue;
+
+        if (len + LCD_GLYPH_CMD_BYTES > LCD_TX_MAX_BYTES) {
+            send(cmd, len, LCD_GLYPH_SETTLE_MS * (len / LCD_GLYPH_CMD_BYTES), 0, LCD_TIMEOUT_EEPROM_MS, loading);
+            len = 0;
+            loading = 0;
+        }
+        cmd[len++] = LCD_CMD_SETTING;
+        cmd[len++] = (uint8_t)(LCD_SETTING_CREATE_CHAR + slot);
+        memcpy(&cmd[len], rows, sizeof(rows));
+        len += sizeof(rows);
+        loading |= bit;
+        memcpy(device.cgram[slot], rows, sizeof(rows));
+        device.cgram_known |= bit;
+        loaded++;
+    }
+    if (len) send(cmd, len, LCD_GLYPH_SETTLE_MS * (len / LCD_GLYPH_CMD_BYTES), 0, LCD_TIMEOUT_EEPROM_MS, loading);
+    return loaded;
+}
+
+/**
+ * @brief Map every character shown inverse to a CGRAM slot holding its inverted glyph.
+ *
+ * Space and the ROM's full block (0xFF) are each other's inverse and need no slot. Slots
+ * of inverse_slots that already hold a wanted glyph keep it. Then, in screen order, each
+ * span whose missing glyphs all fit in the slots no inverse cell needs gets them; a span
+ * that does not fit gets none, falls back to brackets (LcdFrame::resolve()) and leaves
+ * the slots to later spans. Uploads are rate limited by inverse_load_ms, since each one
+ * writes the SerLCD's EEPROM; a span that needs one earlier falls back to brackets too,
+ * and attr_deadline_us() wakes the render loop when it may load.
+ *
+ * Blinking cells follow a phase derived from lcd_now_us(), so every panel toggles them
+ * in the same frame; a toggle only dirties the rows that have blinking cells and costs
+ * one batch of cell writes. (Toggling a shared CGRAM glyph instead would cost less on
+ * the bus, but the SerLCD firmware stores every custom character in EEPROM, which would
+ * not survive a glyph write per blink for long.)
+ */
+void LcdPanel::resolve_attributes(int64_t now_us)
+{
+    bool blink_on = blink_ms == 0 || (now_us / ((int64_t)blink_ms * 1000)) % 2 == 0;
+    if (blink_on != _blink_on) {
+        _blink_on = blink_on;
+        frame.touch_blinking();
+    }
+
+    uint8_t map[256];
+    memset(map, LCD_INVERSE_NONE, sizeof(map));
+    map[' '] = 0xFF;
+    map[0xFF] = ' ';
+
+    LcdGlyph glyph;
+    uint8_t free = inverse_slots;
+    bool may_load = now_us >= _inverse_load_us;
+    bool loaded = false;
+    _inverse_deferred = false;
+    for (int pass = 0; pass < 2; pass++) {
+        for (uint64_t rows = frame.attr_rows(); rows; rows &= rows - 1) {
+            uint8_t row = (uint8_t)__builtin_ctzll(rows);
+            const uint8_t *t = frame.target_row(row);
+            const uint8_t *a = frame.attr_row(row);
+            for (uint8_t col = 0; col < frame.cols();) {
+                if (!(a[col] & LCD_ATTR_INVERSE)) {
+                    col++;
+                    continue;
+                }
+                uint8_t end = col;
+                while (end < frame.cols() && (a[end] & LCD_ATTR_INVERSE)) end++;
+
+                if (pass == 0) {
+                    // keep what CGRAM already holds
+                    for (uint8_t i = col; i < end; i++) {
+                        if (map[t[i]] != LCD_INVERSE_NONE || !lcd_font_a00_inverse(t[i], glyph)) continue;
+                        for (uint8_t slots = inverse_slots; slots; slots &= slots - 1) {
+                            uint8_t slot = (uint8_t)__builtin_ctz(slots);
+                            if ((device.cgram_known & (1 << slot)) &&
+                                memcmp(device.cgram[slot], glyph.rows, LCD_GLYPH_ROWS) == 0) {
+                                map[t[i]] = slot;
+                                free &= (uint8_t)~(1 << slot);
+                                break;
+                            }
+                        }
+                    }
+                } else {
+                    // load what is missing if the whole span fits
+                    uint8_t missing[LCD_CGRAM_SLOTS];
+                    int nmissing = 0;
+                    bool fits = true;
+                    for (uint8_t i = col; i < end && fits; i++) {
+                        uint8_t c = t[i];
+                        if (map[c] != LCD_INVERSE_NONE || memchr(missing, c, nmissing)) continue;
+                        fits = nmissing < __builtin_popcount(free) && lcd_font_a00(c, glyph);
+                        if (fits) missing[nmissing++] = c;
+                    }
+                    if (fits && nmissing && !may_load) {
+                        fits = false;
+                        _inverse_deferred = true;
+                    }
+                    if (fits && nmissing) {
+                        const LcdGlyph *load[LCD_CGRAM_SLOTS] = {};
+                        LcdGlyph glyphs[LCD_CGRAM_SLOTS];
+                        for (int i = 0; i < nmissing; i++) {
+                            uint8_t slot = (uint8_t)__builtin_ctz(free);
+                            free &= (uint8_t)~(1 << slot);
+                            lcd_font_a00_inverse(missing[i], glyphs[slot]);
+                            load[slot] = &glyphs[slot];
+                            map[missing[i]] = slot;
+                        }
+                        load_cgram(load, false);
+                        loaded = true;
+                    }
+                }
+                col = end;
+            }
+        }
+    }
+
+    if (loaded) _inverse_load_us = now_us + (int64_t)inverse_load_ms * 1000;
+
+    if (memcmp(map, _inverse, sizeof(map)) != 0) {
+        memcpy(_inverse, map, sizeof(map));
+        frame.touch_attributed();
+    }
+    frame.resolve(_inverse, _blink_on);
+}
+
+int64_t LcdPanel::attr_deadline_us(int64_t now_us)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    int64_t deadline = 0;
+    if (blink_ms && frame.blink_rows()) {
+        int64_t period = (int64_t)blink_ms * 1000;
+        deadline = (now_us / period + 1) * period;
+    }
+    if (_inverse_deferred && (deadline == 0 || _inverse_load_us < deadline)) deadline = _inverse_load_us;
+    return deadline;
+}
+
+esp_err_t LcdPanel::enable_pages()
+{
+    if (frame.rows() > 2 || frame.cols() * 2 > LCD_DDRAM_LINE) return ESP_ERR_NOT_SUPPORTED;
+    std::lock_guard<std::mutex> guard(lock);
+    if (_back) return ESP_OK;
+    _back.reset(new LcdFrame(frame.cols(), frame.rows()));
+    _back->set_ddram_offset(frame.ddram_offset() ? 0 : frame.cols());
+    return ESP_OK;
+}
+
+/**
+ * @brief Shift the display so that it shows the front page.
+ */
+void LcdPanel::sync_shift(std::vector<LcdTransaction> &out)
+{
+    uint8_t want = frame.ddram_offset();
+    if ((device.known & LCD_KNOWN_SHIFT) && device.shift == want) return;
+
+    uint8_t cmd[LCD_TX_MAX_BYTES];
+    uint8_t len = 0;
+    uint8_t shifts = want;
+    if ((device.known & LCD_KNOWN_SHIFT) && device.shift < want) {
+        shifts = (uint8_t)(want - device.shift);
+    } else {
+        cmd[len++] = LCD_CMD_SPECIAL;
+        cmd[len++] = LCD_CMD_HOME;
+    }
+    for (uint8_t i = 0; i <= shifts; i++) {
+        if (len + 2 > LCD_TX_MAX_BYTES || (i == shifts && len)) {
+            // return home takes 1.52 ms, shifts 37 us each
+            out.emplace_back();
+            lcd_command_transaction(out.back(), this, addr, cmd, len, cmd[1] == LCD_CMD_HOME ? 2 : 1, LCD_KNOWN_SHIFT,
+                                    LCD_TIMEOUT_COMMAND_MS);
+            len = 0;
+        }
+        if (i == shifts) break;
+        cmd[len++] = LCD_CMD_SPECIAL;
+        cmd[len++] = LCD_CMD_SHIFT_LEFT;
+    }
+    device.shift = want;
+    device.known |= LCD_KNOWN_SHIFT;
+}
+
+void LcdPanel::suspend(bool suspended)
+{
+    _suspended.store(suspended, std::memory_order_relaxed);
+}
+
+LcdFrameGuard LcdPanel::frame_begin()
+{
+    std::unique_lock<std::mutex> held(lock);
+    frame.clear();
+    if (frame.has_attributes()) {
+        for (uint8_t row = 0; row < frame.rows(); row++) frame.set_attr(0, row, frame.cols(), 0);
+    }
+    for (auto &region : _regions) region->invalidate();
+    for (auto &binding : _bindings) binding.invalidate();
+    return LcdFrameGuard(std::move(held), frame);
+}
+
+LcdRegion *LcdPanel::lease(uint8_t col, uint8_t row, uint8_t width, uint8_t height)
+{
+    if (width == 0 || height == 0 || col + width > frame.cols() || row + height > frame.rows()) return nullptr;
+    std::lock_guard<std::mutex> guard(lock);
+    for (auto &region : _regions) {
+        if (region->overlaps(col, row, width, height)) return nullptr;
+    }
+    _regions.emplace_back(new LcdRegion(col, row, width, height));
+    return _regions.back().get();
+}
+
+void LcdPanel::release(LcdRegion *region)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    for (auto it = _regions.begin(); it != _regions.end(); ++it) {
+        if (it->get() == region) {
+            _regions.erase(it);
+            return;
+        }
+    }
+}
+
+void LcdPanel::bind(const LcdBinding &binding)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    _bindings.push_back(binding);
+}
+
+/**
+ * @brief Called by the transmit queue for every transaction of this panel.
+ *
+ * Transactions of a frame rely on the cursor position left by the previous one, so after
+ * a failure the rest of the frame is skipped (@p err is then ESP_ERR_INVALID_STATE) and
+ * the cells are re-planned from the shadow buffer in the next frame. Transactions
+ * cancelled at the frame deadline (ESP_ERR_NOT_FINISHED) were not sent either. A clear
+ * that did not go out for any of these reasons is planned again with the next frame.
+ */
+void LcdPanel::complete(const LcdTransaction &tx, esp_err_t err)
+{
+    if (err != ESP_ERR_INVALID_STATE && err != ESP_ERR_NOT_FINISHED) {
+        if (health.record(err, lcd_now_us())) {
+            // back from offline: whatever the panel had is gone
+            std::lock_guard<std::mutex> guard(lock);
+            device.forget();
+            _resync.store(true);
+        }
+    }
+    LcdFrame &page = tx.back ? *_back : frame; // pages only swap in plan(), never with a frame in flight
+    if (err == ESP_OK) {
+        page.commit(tx);
+    } else {
+        std::lock_guard<std::mutex> guard(lock); // forget() marks rows dirty, which drawing threads do too
+        // a failed write may be half written; skipped and cancelled ones were not sent,
+        // which only matters for cells assumed sent when planned
+        if (tx.assumed || (err != ESP_ERR_INVALID_STATE && err != ESP_ERR_NOT_FINISHED)) page.forget(tx);
+        device.known &= (uint8_t)~tx.known; // resend the setting next time
+        device.cgram_known &= (uint8_t)~tx.cgram;
+        if (tx.clears) _resync.store(true); // the display still shows what the frame assumed gone
+        _failed.store(true, std::memory_order_relaxed);
+    }
+    if (_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        _failed.store(false, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,232 @@
+/**
+ * @file lcd_panel.h
+ * @brief One physical display: its frame, its bus address and its in-flight state.
+ */
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "lcd_binding.h"
+#include "lcd_device_state.h"
+#include "lcd_frame.h"
+#include "lcd_panel_health.h"
+#include "lcd_port.h"
+#include "lcd_region.h"
+
+#define LCD_GLYPH_CMD_BYTES  (2 + LCD_GLYPH_ROWS) /*!< one create-char command */
+#define LCD_BLINK_MS         500 /*!< default blink half period */
+#define LCD_GLYPH_SETTLE_MS  30 /*!< per glyph: the firmware also writes it to EEPROM, 8 bytes at 3.3 ms */
+#define LCD_INVERSE_LOAD_MS  60000 /*!< default least time between inverse glyph uploads */
+
+/**
+ * @brief An immediate-mode frame in progress, from LcdPanel::frame_begin(). Holds the
+ *        panel lock until it goes out of scope; draw through it like an LcdFrame *.
+ */
+class LcdFrameGuard {
+public:
+    LcdFrameGuard(std::unique_lock<std::mutex> held, LcdFrame &frame) : _held(std::move(held)), _frame(frame) {}
+
+    LcdFrame &operator*() const { return _frame; }
+    LcdFrame *operator->() const { return &_frame; }
+
+private:
+    std::unique_lock<std::mutex> _held;
+    LcdFrame &_frame;
+};
+
+class LcdPanel {
+public:
+    LcdPanel(uint8_t addr, uint8_t port, uint8_t cols = 20, uint8_t rows = 4);
+
+    LcdFrame frame;     /*!< target side is guarded by lock, shadow side by pending */
+    std::mutex lock;    /*!< held by whoever draws into the target buffer */
+    const uint8_t addr; /*!< 7-bit I2C address */
+    const uint8_t port; /*!< index of the transmit queue that owns the bus */
+    LcdDeviceState device; /*!< CGRAM and settings as last sent; guarded by lock */
+    uint16_t frame_budget_ms = LCD_FRAME_BUDGET_MS; /*!< 0 for no frame deadline */
+    LcdPanelHealth health;
+    uint8_t inverse_slots = 0; /*!< CGRAM slots inverse video may use, e.g. 0xF0; keep own glyphs out of them. Guarded by lock */
+    /**
+     * Least time between inverse glyph uploads. The SerLCD firmware writes every custom
+     * character to its EEPROM (rated for 100,000 writes), so a highlight that keeps moving
+     * over new characters would wear it out. Spans that would need an upload sooner show
+     * bracket markers until then. 0 for no limit, e.g. on a PCF8574 backpack, whose CGRAM
+     * is plain RAM. Guarded by lock.
+     */
+    uint32_t inverse_load_ms = LCD_INVERSE_LOAD_MS;
+    uint16_t blink_ms = LCD_BLINK_MS; /*!< LCD_ATTR_BLINK half period; the phase is shared by all panels */
+
+    /**
+     * @brief Diff and encode the panel if its previous frame has left the queue.
+     *
+     * All transactions of the frame carry the frame deadline. Whatever has not been sent
+     * by then is cancelled and, since the shadow buffer only records what was sent,
+     * re-planned by the next call.
+     * @return number of transactions appended to @p out
+     */
+    size_t plan(std::vector<LcdRun> &runs, std::vector<LcdTransaction> &out);
+
+    /**
+     * @brief Queue a command ahead of the next frame's cell updates. Caller holds lock.
+     * @param known LCD_KNOWN_* bits of device that the command sets
+     * @param cgram CGRAM slots of device that the command loads
+     */
+    void send(const uint8_t *bytes, uint8_t len, uint16_t settle_ms = 0, uint8_t known = 0,
+              uint16_t timeout_ms = LCD_TIMEOUT_COMMAND_MS, uint8_t cgram = 0);
+
+    /**
+     * @brief Replace the screen with content encoded ahead of time, e.g. an LcdLayout.
+     *
+     * @p cells (cols * rows, row major) becomes the frame target now. With the next
+     * frame the display is cleared and @p tx, encoded for a blank display, goes out as
+     * it is, with no diff or encode for those cells; only what was drawn on top since is
+     * diffed. Both arrays must stay valid until then. Caller holds lock.
+     * @return ESP_ERR_INVALID_STATE with pages enabled, whose addresses the encoding
+     *         does not know about
+     */
+    esp_err_t show_encoded(const LcdEncodedTx *tx, size_t count, const uint8_t *cells);
+
+    /**
+     * @brief Queue CGRAM loads for the slots whose glyph differs from device.cgram,
+     *        packed into as few transactions as possible. Caller holds lock.
+     * @param slots glyph per slot, nullptr to leave a slot alone
+     * @param wanted the application's glyphs, restored after a failure or brownout;
+     *        false for the engine's own, which it reloads when it needs them
+     * @return number of slots queued for loading
+     */
+    size_t load_cgram(const LcdGlyph *const slots[LCD_CGRAM_SLOTS], bool wanted = true);
+
+    /**
+     * @brief Redraw every cell after the queued commands, for a command that overwrites
+     *        the screen. Caller holds lock.
+     */
+    void redraw_after_commands() { _redraw = true; }
+
+    /**
+     * @brief While suspended only critical regions are merged and nothing is diffed;
+     *        queued commands still go out. A change to a critical region is reported
+     *        by critical_changed().
+     */
+    void suspend(bool suspended);
+
+    /**
+     * @brief Clear the display ahead of the next frame and redraw every cell.
+     */
+    void reset_display() { _resync.store(true); }
+
+    /**
+     * @brief Page flipping for 2-line displays.
+     *
+     * A 2-line HD44780 has 40 DDRAM columns per line and shows 16 or 20 of them. The back
+     * page lives in the hidden columns and is preloaded whenever a frame has nothing else
+     * to send. flip() then swaps the pages with display-shift commands: a return-home (2
+     * bytes) to show the page at column 0, or one shift per column (2 bytes each) to show
+     * the other one, instead of redrawing every cell. A 4-line display uses all of DDRAM
+     * for its visible rows, so there is nothing to flip to.
+     *
+     * Regions and bindings always draw into the front page, and are drawn again onto the
+     * page that becomes the front on a flip; draw the back page through back(). Cell
+     * attributes are only applied on the front page.
+     * @return ESP_ERR_NOT_SUPPORTED for more than 2 rows or more than 20 columns
+     */
+    esp_err_t enable_pages();
+    LcdFrame *back() // guarded by lock; nullptr without pages
+    {
+        _back_clean = false; // the caller is about to draw
+        return _back.get();
+    }
+    bool back_preloaded() const { return _back_clean; } // flipping now shows no stale cells
+    void flip() // swap the pages with the next frame; caller holds lock
+    {
+        _flip = true;
+        _back_clean = false;
+    }
+    /**
+     * @brief Immediate mode: redraw the whole screen in code every frame.
+     *
+     * frame_begin() takes lock and blanks the target, cells and attributes. Draw the
+     * frame through the returned guard with the ordinary LcdFrame calls; the frame ends
+     * and lock is released when the guard goes out of scope. The target is the back
+     * buffer and the shadow the front: the renderer diffs the two like any other frame,
+     * so only cells that differ from what the display shows go on the bus, no more than
+     * a retained UI that tracks its changes by hand. The renderer never sees a half-drawn
+     * frame. Leased regions and bindings are merged on top again with the next frame.
+     *
+     * lock is not recursive. While the guard lives, the same thread must not call
+     * anything that takes it: lease(), release(), bind(), enable_pages(),
+     * attr_deadline_us(), LcdSettings and LcdCatalog::load_glyphs(), lcd_show_screen(),
+     * lcd_put_field() and the generated field setters, LcdLayout::show() and
+     * set_field(), lcd_rtc_save() and lcd_rtc_restore(). Drawing into a leased
+     * LcdRegion is fine.
+     */
+    [[nodiscard]] LcdFrameGuard frame_begin();
+
+    bool suspended() const { return _suspended.load(std::memory_order_relaxed); }
+    bool critical_changed() { return _critical_changed.exchange(false, std::memory_order_relaxed); }
+
+    /**
+     * @brief Lease a rectangle of the screen to a component.
+     *
+     * The panel owns the region until release(). The pointer is a borrow: whoever leases
+     * the region hands it to exactly one writer (a task, or a widget such as
+     * LcdClockWidget, LcdProgressBar or LcdTextLayout) and must not release it while
+     * that writer can still use it.
+     * @return nullptr if the rectangle is off screen or overlaps an existing lease
+     */
+    LcdRegion *lease(uint8_t col, uint8_t row, uint8_t width, uint8_t height);
+
+    /**
+     * @brief End a lease and free the region.
+     *
+     * Every pointer to @p region dangles afterwards, including those held by widgets, so
+     * stop its writer and destroy the widgets drawing into it first. The cells it drew stay
+     * on screen. A component that comes and goes with its screen should keep its lease
+     * and clear() it instead.
+     */
+    void release(LcdRegion *region);
+
+    /**
+     * @brief Sample @p binding every frame and redraw it when its value changes.
+     */
+    void bind(const LcdBinding &binding);
+
+    /**
+     * @brief Next time cell attributes need a frame, for the render loop to wake up at: a
+     *        blink toggle or a deferred inverse glyph upload. 0 if there is none.
+     */
+    int64_t attr_deadline_us(int64_t now_us);
+
+    bool idle() const { return _pending.load(std::memory_order_acquire) == 0; }
+    bool skipping() const { return _failed.load(std::memory_order_relaxed); }
+
+    void queued(size_t count) { _pending.fetch_add((uint32_t)count, std::memory_order_acq_rel); }
+    void complete(const LcdTransaction &tx, esp_err_t err);
+
+private:
+    void resolve_attributes(int64_t now_us); // caller holds lock
+    void sync_shift(std::vector<LcdTransaction> &out); // caller holds lock
+    void send_encoded(std::vector<LcdTransaction> &out); // caller holds lock
+
+    std::vector<std::unique_ptr<LcdRegion>> _regions; /*!< guarded by lock */
+    std::vector<LcdBinding> _bindings;                /*!< guarded by lock */
+    std::vector<LcdTransaction> _commands;            /*!< guarded by lock */
+    bool _redraw = false;                             /*!< guarded by lock */
+    const LcdEncodedTx *_encoded = nullptr;           /*!< show_encoded() for the next frame; guarded by lock */
+    size_t _encoded_count = 0;                        /*!< guarded by lock */
+    const uint8_t *_encoded_cells = nullptr;          /*!< guarded by lock */
+    std::unique_ptr<LcdFrame> _back;                  /*!< hidden page; guarded by lock */
+    bool _flip = false;                               /*!< guarded by lock */
+    std::atomic<bool> _back_clean{false};
+    bool _blink_on = true;                            /*!< guarded by lock */
+    uint8_t _inverse[256];                            /*!< CGRAM code of each inverse character; guarded by lock */
+    int64_t _inverse_load_us = 0;                     /*!< earliest next inverse glyph upload; guarded by lock */
+    bool _inverse_deferred = false;                   /*!< a span waits for _inverse_load_us; guarded by lock */
+    std::atomic<bool> _suspended;
+    std::atomic<bool> _critical_changed;
+    std::atomic<bool> _resync;      /*!< clear and redraw with the next frame */
+    std::atomic<uint32_t> _pending; /*!< transactions queued and not completed */
+    std::atomic<bool> _failed;      /*!< a transaction of the current frame failed */
+};
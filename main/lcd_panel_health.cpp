@@ -0,0 +1,91 @@
+#include "lcd_panel_health.h"
+
+static const char *TAG = "lcd health";
+
+void LcdPanelHealth::enter(LcdHealth state, int64_t now_us)
+{
+    if (state == _stats.state) return;
+    ESP_LOGW(TAG, "panel health %d -> %d", _stats.state, state);
+    _stats.state = state;
+    switch (state) {
+    case LCD_HEALTH_HEALTHY:
+        _stats.to_healthy++;
+        break;
+    case LCD_HEALTH_DEGRADED:
+        _stats.to_degraded++;
+        break;
+    case LCD_HEALTH_OFFLINE:
+        _stats.to_offline++;
+        _backoff_ms = LCD_HEALTH_PROBE_MIN_MS;
+        _next_us = now_us + (int64_t)_backoff_ms * 1000;
+        _probe_out = false;
+        break;
+    }
+}
+
+bool LcdPanelHealth::record(esp_err_t err, int64_t now_us)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    _probe_out = false;
+    if (err != ESP_OK) {
+        _stats.failures++;
+        _ok_streak = 0;
+        if (_fail_streak < 255) _fail_streak++;
+        if (_fail_streak >= LCD_HEALTH_OFFLINE_AFTER) {
+            enter(LCD_HEALTH_OFFLINE, now_us);
+        } else if (_fail_streak >= LCD_HEALTH_DEGRADED_AFTER && _stats.state == LCD_HEALTH_HEALTHY) {
+            enter(LCD_HEALTH_DEGRADED, now_us);
+        }
+        return false;
+    }
+
+    _fail_streak = 0;
+    if (_ok_streak < 255) _ok_streak++;
+    if (_stats.state == LCD_HEALTH_OFFLINE) {
+        enter(LCD_HEALTH_HEALTHY, now_us);
+        return true;
+    }
+    if (_stats.state == LCD_HEALTH_DEGRADED && _ok_streak >= LCD_HEALTH_RECOVER_AFTER) {
+        enter(LCD_HEALTH_HEALTHY, now_us);
+    }
+    return false;
+}
+
+bool LcdPanelHealth::frame_due(int64_t now_us)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    switch (_stats.state) {
+    case LCD_HEALTH_HEALTHY:
+        return true;
+    case LCD_HEALTH_DEGRADED:
+        if (now_us < _next_us) return false;
+        _next_us = now_us + LCD_HEALTH_DEGRADED_FRAME_MS * 1000;
+        return true;
+    case LCD_HEALTH_OFFLINE:
+        break;
+    }
+    return false;
+}
+
+bool LcdPanelHealth::probe_due(int64_t now_us)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    if (_stats.state != LCD_HEALTH_OFFLINE || _probe_out || now_us < _next_us) return false;
+    _probe_out = true;
+    _stats.probes++;
+    _next_us = now_us + (int64_t)_backoff_ms * 1000;
+    _backoff_ms = _backoff_ms * 2 < LCD_HEALTH_PROBE_MAX_MS ? _backoff_ms * 2 : LCD_HEALTH_PROBE_MAX_MS;
+    return true;
+}
+
+LcdHealth LcdPanelHealth::state() const
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    return _stats.state;
+}
+
+LcdHealthStats LcdPanelHealth::stats() const
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    return _stats;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file lcd_panel_health.h
+ * @brief Per-panel health: healthy, degraded, offline.
+ *
+ * A streak of failed writes (NACK or timeout) first marks a panel degraded, which
+ * throttles its frames, then offline. An offline panel gets no frames at all, only an
+ * address probe with exponential backoff. When a probe is acknowledged the panel is
+ * healthy again and needs a resync, since a panel that was unplugged or browned out
+ * has lost its contents and settings.
+ */
+#pragma once
+
+#include <mutex>
+
+#include "lcd_port.h"
+
+#define LCD_HEALTH_DEGRADED_AFTER   2    /*!< consecutive failures */
+#define LCD_HEALTH_OFFLINE_AFTER    5    /*!< consecutive failures */
+#define LCD_HEALTH_RECOVER_AFTER    3    /*!< consecutive successes while degraded */
+#define LCD_HEALTH_DEGRADED_FRAME_MS 200 /*!< minimum frame interval while degraded */
+#define LCD_HEALTH_PROBE_MIN_MS     100
+#define LCD_HEALTH_PROBE_MAX_MS     5000
+
+enum LcdHealth {
+    LCD_HEALTH_HEALTHY,
+    LCD_HEALTH_DEGRADED,
+    LCD_HEALTH_OFFLINE,
+};
+
+struct LcdHealthStats {
+    LcdHealth state;
+    uint32_t failures;        /*!< failed writes, total */
+    uint32_t probes;          /*!< probes sent while offline */
+    uint32_t to_degraded;     /*!< transitions into each state */
+    uint32_t to_offline;
+    uint32_t to_healthy;
+};
+
+class LcdPanelHealth {
+public:
+    /**
+     * @brief Account the result of a write or probe that reached the transport.
+     * @return true if the panel just came back from offline and must be resynced
+     */
+    bool record(esp_err_t err, int64_t now_us);
+
+    /**
+     * @brief May a frame be planned now? Offline panels never get frames.
+     */
+    bool frame_due(int64_t now_us);
+
+    /**
+     * @brief Is it time to probe an offline panel? Arms the next backoff step.
+     */
+    bool probe_due(int64_t now_us);
+
+    LcdHealth state() const;
+    LcdHealthStats stats() const;
+
+private:
+    void enter(LcdHealth state, int64_t now_us);
+
+    mutable std::mutex _lock;
+    LcdHealthStats _stats = {};
+    uint8_t _fail_streak = 0;
+    uint8_t _ok_streak = 0;
+    bool _probe_out = false;   /*!< a probe is queued and not yet recorded */
+    uint32_t _backoff_ms = LCD_HEALTH_PROBE_MIN_MS;
+    int64_t _next_us = 0;      /*!< next frame (degraded) or probe (offline) */
+};
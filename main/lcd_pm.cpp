@@ -0,0 +1,63 @@
+#include "lcd_pm.h"
+
+static const char *TAG = "lcd pm";
+
+LcdPmLock::LcdPmLock()
+{
+}
+
+LcdPmLock::~LcdPmLock()
+{
+    if (_held) release();
+#if defined(ESP_PLATFORM) && CONFIG_PM_ENABLE
+    if (_handle) esp_pm_lock_delete(_handle);
+#endif
+}
+
+esp_err_t LcdPmLock::init(const char *name)
+{
+    _start_us = lcd_now_us();
+#if defined(ESP_PLATFORM) && CONFIG_PM_ENABLE
+    if (_handle) return ESP_OK;
+    esp_err_t err = esp_pm_lock_create(ESP_PM_APB_FREQ_MAX, 0, name, &_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "esp_pm_lock_create failed: %s", esp_err_to_name(err));
+        return err;
+    }
+#else
+    (void)name;
+    (void)TAG;
+#endif
+    return ESP_OK;
+}
+
+void LcdPmLock::acquire()
+{
+    if (_held) return;
+#if defined(ESP_PLATFORM) && CONFIG_PM_ENABLE
+    if (_handle) esp_pm_lock_acquire(_handle);
+#endif
+    _since_us = lcd_now_us();
+    _held = true;
+}
+
+void LcdPmLock::release()
+{
+    if (!_held) return;
+    _total_us += lcd_now_us() - _since_us;
+    _held = false;
+#if defined(ESP_PLATFORM) && CONFIG_PM_ENABLE
+    if (_handle) esp_pm_lock_release(_handle);
+#endif
+}
+
+int64_t LcdPmLock::held_us() const
+{
+    return _total_us + (_held ? lcd_now_us() - _since_us : 0);
+}
+
+float LcdPmLock::held_fraction() const
+{
+    int64_t elapsed = lcd_now_us() - _start_us;
+    return elapsed > 0 ? (float)held_us() / (float)elapsed : 0.0f;
+}
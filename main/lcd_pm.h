@@ -0,0 +1,42 @@
+/**
+ * @file lcd_pm.h
+ * @brief Power management lock held only while a display transfer is in progress.
+ *
+ * With CONFIG_PM_ENABLE the chip scales its clocks down and enters automatic light
+ * sleep whenever no lock is held. A transmit queue takes this lock when it picks up a
+ * transaction after being idle and gives it back when it runs dry, so the chip sleeps
+ * between frames. The lock also accounts how long it was held, which is the fraction
+ * of time the display kept the chip awake.
+ */
+#pragma once
+
+#include <atomic>
+
+#include "lcd_port.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_pm.h"
+#endif
+
+class LcdPmLock {
+public:
+    LcdPmLock();
+    ~LcdPmLock();
+
+    esp_err_t init(const char *name);
+    void acquire();
+    void release();
+
+    int64_t held_us() const;  // total, including a hold in progress
+    float held_fraction() const; // of the time since init()
+
+private:
+#if defined(ESP_PLATFORM) && CONFIG_PM_ENABLE
+    esp_pm_lock_handle_t _handle = nullptr;
+#endif
+    // written by the owning thread, read by anyone for the statistics
+    std::atomic<bool> _held{false};
+    std::atomic<int64_t> _since_us{0}; /*!< when the current hold started */
+    std::atomic<int64_t> _total_us{0}; /*!< completed holds */
+    int64_t _start_us = 0;             /*!< init() time */
+};
@@ -0,0 +1,64 @@
+#include "lcd_power_policy.h"
+
+static const char *TAG = "lcd power";
+
+LcdPowerPolicy::LcdPowerPolicy(LcdPanel &panel, const LcdPowerConfig &config)
+    : _panel(panel), _settings(panel), _config(config), _last_activity_us(lcd_now_us())
+{
+}
+
+void LcdPowerPolicy::activity()
+{
+    _last_activity_us.store(lcd_now_us(), std::memory_order_relaxed);
+    _woken.store(true, std::memory_order_relaxed);
+}
+
+void LcdPowerPolicy::enter(LcdPowerState state)
+{
+    if (state == _state) return;
+    ESP_LOGD(TAG, "power state %d -> %d", _state, state);
+    switch (state) {
+    case LCD_POWER_ACTIVE:
+        _settings.set_display(true);
+        _settings.set_backlight_fast(_config.red, _config.green, _config.blue);
+        _panel.suspend(false);
+        break;
+    case LCD_POWER_DIMMED:
+        _settings.set_display(true);
+        _settings.set_backlight_fast(_config.dim_red, _config.dim_green, _config.dim_blue);
+        _panel.suspend(false);
+        break;
+    case LCD_POWER_OFF:
+        _panel.suspend(true);
+        _settings.set_backlight_fast(0, 0, 0);
+        _settings.set_display(false);
+        break;
+    }
+    _state = state;
+}
+
+LcdPowerState LcdPowerPolicy::poll()
+{
+    if (_panel.critical_changed()) activity();
+    if (_woken.exchange(false, std::memory_order_relaxed)) enter(LCD_POWER_ACTIVE);
+
+    int64_t idle_ms = (lcd_now_us() - _last_activity_us.load(std::memory_order_relaxed)) / 1000;
+    if (_config.off_after_ms && idle_ms >= _config.off_after_ms) {
+        enter(LCD_POWER_OFF);
+    } else if (_config.dim_after_ms && idle_ms >= _config.dim_after_ms) {
+        enter(LCD_POWER_DIMMED);
+    }
+    return _state;
+}
+
+uint32_t LcdPowerPolicy::next_deadline_ms() const
+{
+    int64_t idle_ms = (lcd_now_us() - _last_activity_us.load(std::memory_order_relaxed)) / 1000;
+    int64_t next = INT64_MAX;
+    if (_state == LCD_POWER_ACTIVE && _config.dim_after_ms) next = _config.dim_after_ms - idle_ms;
+    if (_state != LCD_POWER_OFF && _config.off_after_ms && _config.off_after_ms - idle_ms < next) {
+        next = _config.off_after_ms - idle_ms;
+    }
+    if (next == INT64_MAX) return UINT32_MAX;
+    return next > 0 ? (uint32_t)next : 0;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file lcd_power_policy.h
+ * @brief Inactivity policy: dim the backlight, then turn the display off.
+ *
+ * After dim_after_ms without activity() the backlight is dimmed with the fast RGB
+ * command (no EEPROM write, no system message). After off_after_ms the display is turned
+ * off and the panel suspended: only regions marked critical keep being merged, and a
+ * change to one of them wakes the screen like a user event does.
+ *
+ * The controller keeps DDRAM while the display is off, so waking only sends the display
+ * on command, the backlight and the diff of whatever changed meanwhile.
+ */
+#pragma once
+
+#include <atomic>
+
+#include "lcd_settings.h"
+
+struct LcdPowerConfig {
+    uint32_t dim_after_ms; /*!< 0 to never dim */
+    uint32_t off_after_ms; /*!< 0 to never turn off; counted from the last activity */
+    uint8_t red, green, blue; /*!< normal backlight */
+    uint8_t dim_red, dim_green, dim_blue;
+};
+
+enum LcdPowerState {
+    LCD_POWER_ACTIVE,
+    LCD_POWER_DIMMED,
+    LCD_POWER_OFF,
+};
+
+class LcdPowerPolicy {
+public:
+    LcdPowerPolicy(LcdPanel &panel, const LcdPowerConfig &config);
+
+    void activity(); // user event, any task or ISR-free context
+    LcdPowerState poll(); // call before each render; applies due transitions
+    LcdPowerState state() const { return _state; }
+
+    /**
+     * @brief Milliseconds until poll() has something to do, for the render loop's wait.
+     */
+    uint32_t next_deadline_ms() const;
+
+private:
+    void enter(LcdPowerState state);
+
+    LcdPanel &_panel;
+    LcdSettings _settings;
+    LcdPowerConfig _config;
+    LcdPowerState _state = LCD_POWER_ACTIVE;
+    std::atomic<int64_t> _last_activity_us;
+    std::atomic<bool> _woken{false};
+};
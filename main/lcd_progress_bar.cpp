@@ -0,0 +1,34 @@
+#include <stdio.h>
+
+#include "lcd_progress_bar.h"
+
+LcdProgressBar::LcdProgressBar(LcdRegion *region, uint8_t row, bool percent)
+    : _region(region), _row(row), _percent(percent && region->width() > 4), _filled(-1), _shown(-1)
+{
+    _width = _percent ? region->width() - 4 : region->width();
+}
+
+void LcdProgressBar::set(uint32_t done, uint32_t total)
+{
+    if (total == 0) return;
+    if (done > total) done = total;
+    int16_t filled = (int16_t)((uint64_t)done * _width / total);
+    int16_t percent = (int16_t)((uint64_t)done * 100 / total);
+
+    if (_filled < 0) {
+        for (uint8_t col = 0; col < _width; col++) {
+            _region->put_char(col, _row, col < filled ? LCD_PROGRESS_BLOCK : ' ');
+        }
+    } else {
+        for (int16_t col = _filled; col < filled; col++) _region->put_char((uint8_t)col, _row, LCD_PROGRESS_BLOCK);
+        for (int16_t col = filled; col < _filled; col++) _region->put_char((uint8_t)col, _row, ' ');
+    }
+    _filled = filled;
+
+    if (_percent && percent != _shown) {
+        char text[8];
+        snprintf(text, sizeof(text), "%3d%%", percent);
+        _region->put(_width, _row, text);
+        _shown = percent;
+    }
+}
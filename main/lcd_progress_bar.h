@@ -0,0 +1,37 @@
+/**
+ * @file lcd_progress_bar.h
+ * @brief Progress bar with a percentage, e.g. for OTA updates.
+ *
+ * Call set() from the writer between flash writes:
+ *
+ *     esp_ota_write(handle, chunk, len);
+ *     bar.set(written += len, image_size);
+ *
+ * Only the cells that changed are written to the region, so a step costs a block or a
+ * digit. The display updates between flash writes, as long as the render and transmit
+ * tasks outrank the OTA task. With CONFIG_LCD_I2C_ISR_IRAM_SAFE a write that is in
+ * flight when a flash write starts still completes instead of timing out.
+ */
+#pragma once
+
+#include "lcd_region.h"
+
+#define LCD_PROGRESS_BLOCK 0xFF /*!< HD44780 A00 ROM full block */
+
+class LcdProgressBar {
+public:
+    /**
+     * @param percent reserve the last four cells of the row for "100%"
+     */
+    LcdProgressBar(LcdRegion *region, uint8_t row, bool percent = true);
+
+    void set(uint32_t done, uint32_t total);
+
+private:
+    LcdRegion *_region;
+    uint8_t _row;
+    uint8_t _width;   /*!< cells of the bar itself */
+    bool _percent;
+    int16_t _filled;  /*!< shown blocks, -1 before the first set() */
+    int16_t _shown;   /*!< shown percentage */
+};
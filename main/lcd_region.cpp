@@ -0,0 +1,120 @@
+#include <string.h>
+
+#include "lcd_region.h"
+
+#define LCD_REGION_MERGE_TRIES 3
+
+LcdRegion::LcdRegion(uint8_t col, uint8_t row, uint8_t width, uint8_t height)
+    : _col(col), _row(row), _width(width), _height(height < LCD_REGION_MAX_ROWS ? height : LCD_REGION_MAX_ROWS),
+      _cells(new uint8_t[(size_t)width * _height]), _attrs(new uint8_t[(size_t)width * _height]), _attrs_used(false),
+      _seq(0), _dirty(0)
+{
+    memset(_cells.get(), ' ', (size_t)_width * _height);
+    memset(_attrs.get(), 0, (size_t)_width * _height);
+}
+
+void LcdRegion::end_write(uint32_t rows)
+{
+    _seq.fetch_add(1, std::memory_order_release);
+    _dirty.fetch_or(rows, std::memory_order_release);
+}
+
+void LcdRegion::clear()
+{
+    begin_write();
+    memset(_cells.get(), ' ', (size_t)_width * _height);
+    end_write(_height >= 32 ? 0xFFFFFFFFu : ((1u << _height) - 1));
+}
+
+void LcdRegion::put_char(uint8_t col, uint8_t row, uint8_t c)
+{
+    if (col >= _width || row >= _height) return;
+    begin_write();
+    _cells[(size_t)row * _width + col] = LcdFrame::sanitize(c);
+    end_write(1u << row);
+}
+
+uint8_t LcdRegion::put(uint8_t col, uint8_t row, const char *text)
+{
+    if (row >= _height) return 0;
+    uint8_t written = 0;
+    begin_write();
+    for (; col < _width && *text; col++, text++, written++) {
+        _cells[(size_t)row * _width + col] = LcdFrame::sanitize((uint8_t)*text);
+    }
+    end_write(written ? 1u << row : 0);
+    return written;
+}
+
+void LcdRegion::put_cells(uint8_t col, uint8_t row, const uint8_t *cells, uint8_t len)
+{
+    if (col >= _width || row >= _height) return;
+    if (len > _width - col) len = _width - col;
+    begin_write();
+    memcpy(&_cells[(size_t)row * _width + col], cells, len);
+    end_write(len ? 1u << row : 0);
+}
+
+uint8_t LcdRegion::put_padded(uint8_t row, const char *text, size_t len)
+{
+    if (row >= _height) return 0;
+    uint8_t written = 0;
+    begin_write();
+    uint8_t *cells = &_cells[(size_t)row * _width];
+    for (uint8_t col = 0; col < _width; col++) {
+        if (written < len && *text) {
+            cells[col] = LcdFrame::sanitize((uint8_t)*text++);
+            written++;
+        } else {
+            cells[col] = ' ';
+        }
+    }
+    end_write(1u << row);
+    return written;
+}
+
+void LcdRegion::set_attr(uint8_t col, uint8_t row, uint8_t len, uint8_t attr, bool on)
+{
+    if (col >= _width || row >= _height) return;
+    if (len > _width - col) len = _width - col;
+    begin_write();
+    _attrs_used.store(true, std::memory_order_relaxed);
+    uint8_t *attrs = &_attrs[(size_t)row * _width + col];
+    for (uint8_t i = 0; i < len; i++) {
+        attrs[i] = on ? (uint8_t)(attrs[i] | attr) : (uint8_t)(attrs[i] & ~attr);
+    }
+    end_write(1u << row);
+}
+
+bool LcdRegion::overlaps(uint8_t col, uint8_t row, uint8_t width, uint8_t height) const
+{
+    return col < _col + _width && _col < col + width && row < _row + _height && _row < row + height;
+}
+
+bool LcdRegion::merge(LcdFrame &frame)
+{
+    uint32_t rows = _dirty.exchange(0, std::memory_order_acquire);
+    if (rows == 0) return true;
+
+    uint8_t copy[255]; // one region row at a time
+    uint8_t copy_attrs[255];
+    bool attrs = _attrs_used.load(std::memory_order_relaxed); // published by the _dirty acquire
+    for (int tries = 0; tries < LCD_REGION_MERGE_TRIES; tries++) {
+        uint32_t before = _seq.load(std::memory_order_acquire);
+        if (before & 1) continue; // write in progress
+        bool torn = false;
+        for (uint32_t pending = rows; pending && !torn; pending &= pending - 1) {
+            uint8_t r = (uint8_t)__builtin_ctz(pending);
+            memcpy(copy, &_cells[(size_t)r * _width], _width);
+            if (attrs) memcpy(copy_attrs, &_attrs[(size_t)r * _width], _width);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            torn = _seq.load(std::memory_order_relaxed) != before;
+            if (torn) break;
+            frame.put_cells(_col, (uint8_t)(_row + r), copy, _width);
+            if (attrs) frame.put_attrs(_col, (uint8_t)(_row + r), copy_attrs, _width);
+        }
+        if (!torn) return true;
+    }
+    _dirty.fetch_or(rows, std::memory_order_relaxed); // retry next frame
+    return false;
+}
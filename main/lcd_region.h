@@ -0,0 +1,73 @@
+/**
+ * @file lcd_region.h
+ * @brief Rectangular screen regions leased to independent application components.
+ *
+ * A component that owns a region writes region-relative text into it without any lock
+ * and without touching the cursor; writes are clipped to the region. The renderer copies
+ * the rows a region marked dirty into the panel frame when it plans the next frame, so
+ * components never contend with each other or with the renderer.
+ *
+ * Each region has exactly one writer. The renderer reads it under a sequence counter
+ * and retries (or leaves the rows for the next frame) if it overlaps a write.
+ */
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "lcd_frame.h"
+
+#define LCD_REGION_MAX_ROWS 32 /*!< rows tracked by a region's dirty mask */
+
+class LcdRegion {
+public:
+    LcdRegion(uint8_t col, uint8_t row, uint8_t width, uint8_t height);
+
+    uint8_t col() const { return _col; }
+    uint8_t row() const { return _row; }
+    uint8_t width() const { return _width; }
+    uint8_t height() const { return _height; }
+
+    // writer side, region-relative coordinates, clipped to the region
+    void clear();
+    void put_char(uint8_t col, uint8_t row, uint8_t c);
+    uint8_t put(uint8_t col, uint8_t row, const char *text);
+    void put_cells(uint8_t col, uint8_t row, const uint8_t *cells, uint8_t len); // already sanitized
+    uint8_t put_padded(uint8_t row, const char *text, size_t len = SIZE_MAX); // whole row, space filled
+    void set_inverse(uint8_t col, uint8_t row, uint8_t len, bool inverse) { set_attr(col, row, len, LCD_ATTR_INVERSE, inverse); }
+    void set_blink(uint8_t col, uint8_t row, uint8_t len, bool blink) { set_attr(col, row, len, LCD_ATTR_BLINK, blink); }
+
+    void set_critical(bool critical) { _critical = critical; } // keeps rendering while the panel is suspended
+    bool critical() const { return _critical; }
+    bool dirty() const { return _dirty.load(std::memory_order_relaxed) != 0; }
+
+    void invalidate() // merge every row again with the next frame
+    {
+        _dirty.fetch_or(_height >= 32 ? 0xFFFFFFFFu : ((1u << _height) - 1), std::memory_order_release);
+    }
+
+    bool overlaps(uint8_t col, uint8_t row, uint8_t width, uint8_t height) const;
+
+    /**
+     * @brief Renderer side: copy rows written since the last merge into @p frame.
+     * @return false if a concurrent write kept tearing the copy; the rows stay dirty
+     */
+    bool merge(LcdFrame &frame);
+
+private:
+    void set_attr(uint8_t col, uint8_t row, uint8_t len, uint8_t attr, bool on);
+    void begin_write() { _seq.fetch_add(1, std::memory_order_acq_rel); }
+    void end_write(uint32_t rows);
+
+    const uint8_t _col;
+    const uint8_t _row;
+    const uint8_t _width;
+    const uint8_t _height;
+    std::unique_ptr<uint8_t[]> _cells;
+    std::unique_ptr<uint8_t[]> _attrs;  /*!< LCD_ATTR_* per cell */
+    std::atomic<bool> _attrs_used;      /*!< an attribute was set; merge attributes too */
+    std::atomic<uint32_t> _seq;   /*!< odd while a write is in progress */
+    std::atomic<uint32_t> _dirty; /*!< bit per region row written since the last merge */
+    bool _critical = false;
+};
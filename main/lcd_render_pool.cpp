@@ -0,0 +1,123 @@
+#include "lcd_render_pool.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_pthread.h"
+#endif
+
+LcdRenderPool::LcdRenderPool(const std::vector<LcdTxQueue *> &ports, size_t workers) : _ports(ports)
+{
+    if (workers == 0) {
+#ifdef ESP_PLATFORM
+        workers = portNUM_PROCESSORS;
+#else
+        workers = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+#endif
+    }
+    for (size_t i = 0; i < workers; i++) {
+        _workers.emplace_back(new Worker());
+    }
+#ifdef ESP_PLATFORM
+    // the config applies to every later std::thread of the calling task; put the caller's back
+    esp_pthread_cfg_t caller;
+    if (esp_pthread_get_cfg(&caller) != ESP_OK) caller = esp_pthread_get_default_config();
+#endif
+    for (size_t i = 0; i < workers; i++) {
+#ifdef ESP_PLATFORM
+        esp_pthread_cfg_t cfg = esp_pthread_get_default_config();
+        cfg.thread_name = "lcd_render";
+        cfg.pin_to_core = (int)(i % portNUM_PROCESSORS);
+        cfg.stack_size = 4096;
+        esp_pthread_set_cfg(&cfg);
+#endif
+        _workers[i]->thread = std::thread(&LcdRenderPool::run, this, i);
+    }
+#ifdef ESP_PLATFORM
+    esp_pthread_set_cfg(&caller);
+#endif
+}
+
+LcdRenderPool::~LcdRenderPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _stop = true;
+        _generation++;
+    }
+    _wake.notify_all();
+    for (auto &worker : _workers) worker->thread.join();
+}
+
+void LcdRenderPool::render(LcdPanel *const *panels, size_t count)
+{
+    size_t queued = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!panels[i]->idle()) continue;
+        Worker &worker = *_workers[queued % _workers.size()];
+        std::lock_guard<std::mutex> guard(worker.lock);
+        worker.jobs.push_back(panels[i]);
+        queued++;
+    }
+    if (queued == 0) return;
+
+    std::unique_lock<std::mutex> guard(_lock);
+    _outstanding += queued;
+    _generation++;
+    _wake.notify_all();
+    _done.wait(guard, [this] { return _outstanding == 0; });
+}
+
+/**
+ * @brief Next job for worker @p self: own deque first, then steal from the others.
+ */
+bool LcdRenderPool::take(size_t self, LcdPanel *&job)
+{
+    {
+        Worker &own = *_workers[self];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.jobs.empty()) {
+            job = own.jobs.front();
+            own.jobs.pop_front();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < _workers.size(); i++) {
+        Worker &victim = *_workers[(self + i) % _workers.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.jobs.empty()) {
+            job = victim.jobs.back();
+            victim.jobs.pop_back();
+            _steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void LcdRenderPool::run(size_t self)
+{
+    Worker &worker = *_workers[self];
+    uint32_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> guard(_lock);
+            _wake.wait(guard, [&] { return _stop || _generation != seen; });
+            if (_stop) return;
+            seen = _generation;
+        }
+        LcdPanel *panel;
+        while (take(self, panel)) {
+            render_panel(worker, panel);
+            std::lock_guard<std::mutex> guard(_lock);
+            if (--_outstanding == 0) _done.notify_all();
+        }
+    }
+}
+
+void LcdRenderPool::render_panel(Worker &worker, LcdPanel *panel)
+{
+    worker.txs.clear();
+    size_t count = panel->plan(worker.runs, worker.txs);
+    if (count == 0) return;
+    panel->queued(count);
+    _ports[panel->port]->push(worker.txs.data(), count);
+}
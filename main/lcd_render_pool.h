@@ -0,0 +1,66 @@
+/**
+ * @file lcd_render_pool.h
+ * @brief Work-stealing pool that diffs and encodes panels in parallel.
+ *
+ * Each worker has its own job deque. A worker takes jobs from the front of its own
+ * deque and, when that is empty, steals from the back of the others. On the ESP32 the
+ * workers are pinned round-robin to the cores; on a host they are plain std::threads,
+ * so the same code can be benchmarked on a Linux box (see tools/bench_render_pool.cpp).
+ * Encoded transactions go to the transmit queue of the panel's port.
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "lcd_panel.h"
+#include "lcd_tx_queue.h"
+
+class LcdRenderPool {
+public:
+    /**
+     * @param ports   transmit queue per port index used by the panels
+     * @param workers number of worker threads, 0 for one per core
+     */
+    LcdRenderPool(const std::vector<LcdTxQueue *> &ports, size_t workers = 0);
+    ~LcdRenderPool();
+
+    /**
+     * @brief Plan every panel and hand the transactions to the transmit queues.
+     *
+     * Returns once all panels are encoded; transmission continues in the queues.
+     * Panels whose previous frame is still queued are skipped this time.
+     */
+    void render(LcdPanel *const *panels, size_t count);
+
+    size_t workers() const { return _workers.size(); }
+    size_t steals() const { return _steals.load(std::memory_order_relaxed); }
+
+private:
+    struct Worker {
+        std::mutex lock;
+        std::deque<LcdPanel *> jobs;
+        std::vector<LcdRun> runs;          // scratch, reused across frames
+        std::vector<LcdTransaction> txs;   // scratch, reused across frames
+        std::thread thread;
+    };
+
+    bool take(size_t self, LcdPanel *&job);
+    void run(size_t self);
+    void render_panel(Worker &worker, LcdPanel *panel);
+
+    std::vector<LcdTxQueue *> _ports;
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::mutex _lock;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    size_t _outstanding = 0; // jobs of the current render() not yet finished, guarded by _lock
+    uint32_t _generation = 0;
+    bool _stop = false;
+    std::atomic<size_t> _steals{0};
+};
@@ -0,0 +1,97 @@
+#include <string.h>
+
+#include "lcd_rtc_state.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#include "esp_rom_crc.h"
+#include "esp_system.h"
+#endif
+
+static const char *TAG = "lcd rtc";
+
+#define LCD_RTC_MAGIC 0x4C434454 /*!< "LCDR", bump on layout changes */
+
+struct LcdRtcBlock {
+    uint32_t magic;
+    uint8_t addr;
+    uint8_t cols;
+    uint8_t rows;
+    uint8_t reserved;
+    LcdDeviceState device;
+    uint8_t cells[LCD_RTC_MAX_CELLS];
+    uint32_t crc; /*!< over everything above */
+};
+
+#ifdef ESP_PLATFORM
+static RTC_DATA_ATTR LcdRtcBlock rtc_block; // zeroed on power-on, kept through deep sleep
+
+static uint32_t block_crc(const LcdRtcBlock &block)
+{
+    return esp_rom_crc32_le(0, reinterpret_cast<const uint8_t *>(&block), offsetof(LcdRtcBlock, crc));
+}
+
+static bool woke_from_deep_sleep(void)
+{
+    return esp_reset_reason() == ESP_RST_DEEPSLEEP;
+}
+#else
+static LcdRtcBlock rtc_block; // host: survives "sleep" within one process only
+
+static uint32_t block_crc(const LcdRtcBlock &block)
+{
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(&block);
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < offsetof(LcdRtcBlock, crc); i++) {
+        crc ^= p[i];
+        for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+    return ~crc;
+}
+
+static bool woke_from_deep_sleep(void)
+{
+    return true;
+}
+#endif
+
+esp_err_t lcd_rtc_save(LcdPanel &panel)
+{
+    if (!panel.idle() || panel.skipping()) return ESP_ERR_INVALID_STATE;
+    size_t cells = (size_t)panel.frame.cols() * panel.frame.rows();
+    if (cells > LCD_RTC_MAX_CELLS) return ESP_ERR_INVALID_SIZE;
+
+    std::lock_guard<std::mutex> guard(panel.lock);
+    memset(&rtc_block, 0, sizeof(rtc_block));
+    rtc_block.magic = LCD_RTC_MAGIC;
+    rtc_block.addr = panel.addr;
+    rtc_block.cols = panel.frame.cols();
+    rtc_block.rows = panel.frame.rows();
+    rtc_block.device = panel.device;
+    panel.frame.save_shadow(rtc_block.cells);
+    rtc_block.crc = block_crc(rtc_block);
+    return ESP_OK;
+}
+
+bool lcd_rtc_restore(LcdPanel &panel)
+{
+    if (!woke_from_deep_sleep()) return false;
+    if (rtc_block.magic != LCD_RTC_MAGIC || rtc_block.crc != block_crc(rtc_block)) {
+        ESP_LOGW(TAG, "retained display state invalid, full redraw");
+        return false;
+    }
+    if (rtc_block.addr != panel.addr || rtc_block.cols != panel.frame.cols() || rtc_block.rows != panel.frame.rows()) {
+        ESP_LOGW(TAG, "retained display state is for another panel");
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard(panel.lock);
+    panel.device = rtc_block.device;
+    panel.frame.restore(rtc_block.cells);
+    return true;
+}
+
+void lcd_rtc_discard(void)
+{
+    rtc_block.magic = 0;
+}
@@ -0,0 +1,41 @@
+/**
+ * @file lcd_rtc_state.h
+ * @brief Keep a panel's shadow buffer and device state in RTC memory across deep sleep.
+ *
+ * The SerLCD stays powered while the ESP32 deep-sleeps, so after a wake the display
+ * still shows what the shadow buffer said. Saving the shadow, the CGRAM contents and the
+ * settings to RTC slow memory before sleeping lets the next boot skip SerLCD::begin(),
+ * clear() and the full redraw; only the cells whose values changed are sent.
+ *
+ * The retained block carries the panel geometry, address and a CRC. It is only trusted
+ * after a deep-sleep wake, when the CRC matches and the panel looks the same.
+ */
+#pragma once
+
+#include "lcd_panel.h"
+
+#define LCD_RTC_MAX_CELLS 160 /*!< 40x4 or 20x8 */
+
+/**
+ * @brief Copy the panel's state into RTC memory. Call right before esp_deep_sleep_start().
+ *
+ * The panel must be idle (no frame in flight), otherwise the shadow is not final.
+ * Cells a failed write left unknown are saved as such and redrawn after the restore.
+ * @return ESP_ERR_INVALID_STATE if a frame is still queued or being skipped after a
+ *         failure, ESP_ERR_INVALID_SIZE if the panel is larger than LCD_RTC_MAX_CELLS
+ */
+esp_err_t lcd_rtc_save(LcdPanel &panel);
+
+/**
+ * @brief Restore the panel from RTC memory after a deep-sleep wake.
+ *
+ * On success both the target and the shadow hold what the device shows, so cells the
+ * application does not redraw stay as they are and redrawn cells only cost their diff.
+ * @return true if the retained state was valid and applied
+ */
+bool lcd_rtc_restore(LcdPanel &panel);
+
+/**
+ * @brief Invalidate the retained block, e.g. when the display lost power.
+ */
+void lcd_rtc_discard(void);
@@ -0,0 +1,35 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "lcd_screen.h"
+
+esp_err_t lcd_show_screen(LcdPanel &panel, LcdSettings &settings, const LcdScreenSpec &screen,
+                          const LcdGlyph *glyphs)
+{
+    settings.load_glyph_page(glyphs, screen.glyphs);
+    std::lock_guard<std::mutex> guard(panel.lock);
+    return panel.show_encoded(screen.tx, screen.tx_count, screen.cells);
+}
+
+void lcd_put_field(LcdPanel &panel, uint8_t col, uint8_t row, uint8_t width, uint8_t align, const char *text)
+{
+    char cells[256];
+    size_t len = strnlen(text, width);
+    size_t pad = align == LCD_LAYOUT_ALIGN_RIGHT ? width - len : 0;
+    memset(cells, ' ', width);
+    memcpy(&cells[pad], text, len);
+    cells[width] = 0;
+    std::lock_guard<std::mutex> guard(panel.lock);
+    panel.frame.put(col, row, cells);
+}
+
+void lcd_field_printf(LcdPanel &panel, const LcdFieldSpec *field, ...)
+{
+    char text[256];
+    va_list args;
+    va_start(args, field);
+    vsnprintf(text, sizeof(text), field->format, args);
+    va_end(args);
+    lcd_put_field(panel, field->col, field->row, field->width, field->align, text);
+}
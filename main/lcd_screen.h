@@ -0,0 +1,60 @@
+/**
+ * @file lcd_screen.h
+ * @brief Screens compiled into constant tables at build time.
+ *
+ * lcd_compile_screens() in tools/lcd_screens.cmake runs tools/layout_gen over a
+ * declarative description (labels, fields with widths, formats and update rates,
+ * widget rectangles) and generates a header with, per screen, the static cells and
+ * their transactions encoded for a blank display, plus a field index. Overlapping
+ * items and fields whose update rates need more of the bus than the budget allows
+ * fail the build. The generated header also has a typed setter per field:
+ *
+ *     #include "lcd_screens.h" // generated
+ *
+ *     lcd_show_screen(panel, settings, LCD_SCREEN_BOILER);
+ *     lcd_set_boiler_temp(panel, 61.5); // field format "%5.1f"
+ *
+ * Showing a screen hands its tables to LcdPanel::show_encoded(); fields are then
+ * ordinary frame writes, diffed like everything else.
+ */
+#pragma once
+
+#include "lcd_layout.h"
+#include "lcd_panel.h"
+#include "lcd_settings.h"
+
+struct LcdScreenSpec {
+    const char *name;
+    const uint8_t *cells;    /*!< cols * rows static cells, row major; fields are blank */
+    const LcdEncodedTx *tx;  /*!< transactions that draw cells on a blank display */
+    uint16_t tx_count;
+    uint8_t glyphs[LCD_CGRAM_SLOTS]; /*!< glyph index per CGRAM slot, LCD_GLYPH_NONE if unused */
+};
+
+struct LcdFieldSpec {
+    uint8_t col;
+    uint8_t row;
+    uint8_t width;
+    uint8_t align;      /*!< LCD_LAYOUT_ALIGN_* */
+    uint16_t rate_hz;   /*!< update rate the bus budget was checked against, 0 if not given */
+    const char *format; /*!< printf format with one conversion, nullptr for plain text */
+};
+
+/**
+ * @brief Switch @p panel to @p screen: load its glyphs, then its static content with
+ *        the next frame.
+ */
+esp_err_t lcd_show_screen(LcdPanel &panel, LcdSettings &settings, const LcdScreenSpec &screen,
+                          const LcdGlyph *glyphs);
+
+/**
+ * @brief Draw @p text into a field rectangle, aligned and padded to @p width. Takes panel.lock.
+ */
+void lcd_put_field(LcdPanel &panel, uint8_t col, uint8_t row, uint8_t width, uint8_t align, const char *text);
+
+/**
+ * @brief Format one value with the field's format and draw it. The generated setters
+ *        pass the type the format asks for. @p field is a pointer because va_start()
+ *        on a reference parameter is undefined behaviour.
+ */
+void lcd_field_printf(LcdPanel &panel, const LcdFieldSpec *field, ...);
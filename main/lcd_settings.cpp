@@ -0,0 +1,267 @@
+#include "lcd_settings.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "nvs.h"
+
+#define LCD_NVS_NAMESPACE "lcd"
+
+/**
+ * @brief NVS image of the EEPROM settings of one panel.
+ */
+struct LcdPersistent {
+    uint8_t known; /*!< LCD_KNOWN_PERSISTENT bits */
+    uint8_t contrast;
+    uint8_t splash_on;
+    uint8_t messages_on;
+};
+
+static void persistent_key(const LcdPanel &panel, char *key, size_t size)
+{
+    snprintf(key, size, "dev%02x", panel.addr);
+}
+#endif
+
+bool LcdSettings::set_backlight_fast(uint8_t red, uint8_t green, uint8_t blue)
+{
+    std::lock_guard<std::mutex> guard(_panel.lock);
+    LcdDeviceState &device = _panel.device;
+    device.wanted |= LCD_KNOWN_BACKLIGHT;
+    if ((device.known & LCD_KNOWN_BACKLIGHT) && device.red == red && device.green == green && device.blue == blue) {
+        return false;
+    }
+    device.red = red;
+    device.green = green;
+    device.blue = blue;
+    send_backlight(_panel);
+    return true;
+}
+
+bool LcdSettings::set_display(bool on)
+{
+    std::lock_guard<std::mutex> guard(_panel.lock);
+    LcdDeviceState &device = _panel.device;
+    device.wanted |= LCD_KNOWN_DISPLAY;
+    if ((device.known & LCD_KNOWN_DISPLAY) && device.display_on == on) return false;
+    device.display_on = on;
+    send_display(_panel);
+    return true;
+}
+
+bool LcdSettings::set_contrast(uint8_t contrast)
+{
+    std::lock_guard<std::mutex> guard(_panel.lock);
+    LcdDeviceState &device = _panel.device;
+    device.wanted |= LCD_KNOWN_CONTRAST;
+    if ((device.known & LCD_KNOWN_CONTRAST) && device.contrast == contrast) return false;
+    device.contrast = contrast;
+    send_contrast(_panel);
+    return true;
+}
+
+bool LcdSettings::set_splash(bool on)
+{
+    std::lock_guard<std::mutex> guard(_panel.lock);
+    LcdDeviceState &device = _panel.device;
+    device.wanted |= LCD_KNOWN_SPLASH;
+    if ((device.known & LCD_KNOWN_SPLASH) && device.splash_on == on) return false;
+    device.splash_on = on;
+    send_splash(_panel);
+    return true;
+}
+
+size_t LcdSettings::load_glyphs(const LcdGlyph *glyphs, size_t count, uint8_t first_slot)
+{
+    const LcdGlyph *slots[LCD_CGRAM_SLOTS] = {};
+    for (size_t i = 0; i < count && first_slot + i < LCD_CGRAM_SLOTS; i++) slots[first_slot + i] = &glyphs[i];
+    return load_slots(slots);
+}
+
+size_t LcdSettings::load_glyph_page(const LcdGlyph *glyphs, const uint8_t page[LCD_CGRAM_SLOTS])
+{
+    const LcdGlyph *slots[LCD_CGRAM_SLOTS] = {};
+    for (uint8_t slot = 0; slot < LCD_CGRAM_SLOTS; slot++) {
+        if (page[slot] != LCD_GLYPH_NONE) slots[slot] = &glyphs[page[slot]];
+    }
+    return load_slots(slots);
+}
+
+size_t LcdSettings::load_slots(const LcdGlyph *const slots[LCD_CGRAM_SLOTS])
+{
+    std::lock_guard<std::mutex> guard(_panel.lock);
+    return _panel.load_cgram(slots);
+}
+
+bool LcdSettings::set_messages(bool on)
+{
+    std::lock_guard<std::mutex> guard(_panel.lock);
+    LcdDeviceState &device = _panel.device;
+    device.messages_wanted = on;
+    device.wanted |= LCD_KNOWN_MESSAGES;
+    if ((device.known & LCD_KNOWN_MESSAGES) && device.messages_on == on) return false;
+    device.messages_on = on;
+    send_messages(_panel);
+    return true;
+}
+
+void LcdSettings::restore(LcdPanel &panel)
+{
+    LcdDeviceState &device = panel.device;
+    uint8_t lost = device.wanted & (uint8_t)~device.known;
+    if (lost & LCD_KNOWN_MESSAGES) send_messages(panel); // ahead of the settings that show one
+    if (lost & LCD_KNOWN_DISPLAY) send_display(panel);
+    if (lost & LCD_KNOWN_BACKLIGHT) send_backlight(panel);
+    if (lost & LCD_KNOWN_CONTRAST) send_contrast(panel);
+    if (lost & LCD_KNOWN_SPLASH) send_splash(panel);
+
+    uint8_t glyphs = device.cgram_wanted & (uint8_t)~device.cgram_known;
+    if (glyphs) {
+        LcdGlyph patterns[LCD_CGRAM_SLOTS];
+        const LcdGlyph *slots[LCD_CGRAM_SLOTS] = {};
+        for (uint8_t slot = 0; slot < LCD_CGRAM_SLOTS; slot++) {
+            if (!(glyphs & (1 << slot))) continue;
+            memcpy(patterns[slot].rows, device.cgram[slot], LCD_GLYPH_ROWS);
+            slots[slot] = &patterns[slot];
+        }
+        panel.load_cgram(slots);
+    }
+}
+
+void LcdSettings::send_backlight(LcdPanel &panel)
+{
+    LcdDeviceState &device = panel.device;
+    const uint8_t cmd[] = {LCD_CMD_SETTING, LCD_SETTING_RGB, device.red, device.green, device.blue};
+    panel.send(cmd, sizeof(cmd), 10, LCD_KNOWN_BACKLIGHT);
+    device.known |= LCD_KNOWN_BACKLIGHT;
+}
+
+void LcdSettings::send_display(LcdPanel &panel)
+{
+    LcdDeviceState &device = panel.device;
+    // cursor and blink stay off; the render engine never shows the cursor
+    const uint8_t cmd[] = {LCD_CMD_SPECIAL,
+                           (uint8_t)(LCD_HD44780_DISPLAY_CONTROL | (device.display_on ? LCD_HD44780_DISPLAY_ON : 0))};
+    panel.send(cmd, sizeof(cmd), 0, LCD_KNOWN_DISPLAY);
+    device.known |= LCD_KNOWN_DISPLAY;
+}
+
+void LcdSettings::send_contrast(LcdPanel &panel)
+{
+    LcdDeviceState &device = panel.device;
+    uint16_t settle_ms = before_message(panel);
+    const uint8_t cmd[] = {LCD_CMD_SETTING, LCD_SETTING_CONTRAST, device.contrast};
+    panel.send(cmd, sizeof(cmd), settle_ms, LCD_KNOWN_CONTRAST, LCD_TIMEOUT_EEPROM_MS);
+    device.known |= LCD_KNOWN_CONTRAST;
+}
+
+void LcdSettings::send_splash(LcdPanel &panel)
+{
+    LcdDeviceState &device = panel.device;
+    const uint8_t cmd[] = {LCD_CMD_SETTING, (uint8_t)(device.splash_on ? LCD_SETTING_SPLASH_ON : LCD_SETTING_SPLASH_OFF)};
+    panel.send(cmd, sizeof(cmd), 10, LCD_KNOWN_SPLASH, LCD_TIMEOUT_EEPROM_MS);
+    device.known |= LCD_KNOWN_SPLASH;
+}
+
+void LcdSettings::send_messages(LcdPanel &panel)
+{
+    LcdDeviceState &device = panel.device;
+    const uint8_t cmd[] = {LCD_CMD_SETTING,
+                           (uint8_t)(device.messages_on ? LCD_SETTING_MESSAGES_ON : LCD_SETTING_MESSAGES_OFF)};
+    panel.send(cmd, sizeof(cmd), 10, LCD_KNOWN_MESSAGES, LCD_TIMEOUT_EEPROM_MS);
+    device.known |= LCD_KNOWN_MESSAGES;
+}
+
+uint16_t LcdSettings::before_message(LcdPanel &panel)
+{
+    LcdDeviceState &device = panel.device;
+    if (device.messages_wanted) {
+        // wait the message out, then put back what it overwrote
+        panel.redraw_after_commands();
+        return LCD_MESSAGE_SETTLE_MS;
+    }
+    if (!(device.known & LCD_KNOWN_MESSAGES) || device.messages_on) {
+        device.messages_on = false;
+        device.wanted |= LCD_KNOWN_MESSAGES;
+        send_messages(panel);
+    }
+    return 10;
+}
+
+#ifdef ESP_PLATFORM
+
+esp_err_t LcdSettings::restore_persistent()
+{
+    char key[8];
+    persistent_key(_panel, key, sizeof(key));
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(LCD_NVS_NAMESPACE, NVS_READONLY, &nvs);
+    if (err == ESP_ERR_NVS_NOT_FOUND) return ESP_ERR_NOT_FOUND;
+    if (err != ESP_OK) return err;
+    LcdPersistent stored;
+    size_t size = sizeof(stored);
+    err = nvs_get_blob(nvs, key, &stored, &size);
+    nvs_close(nvs);
+    if (err == ESP_ERR_NVS_NOT_FOUND) return ESP_ERR_NOT_FOUND;
+    if (err != ESP_OK) return err;
+    if (size != sizeof(stored)) return ESP_ERR_INVALID_SIZE;
+
+    std::lock_guard<std::mutex> guard(_panel.lock);
+    LcdDeviceState &device = _panel.device;
+    uint8_t known = stored.known & LCD_KNOWN_PERSISTENT & ~device.known; // what this boot already set wins
+    if (known & LCD_KNOWN_CONTRAST) device.contrast = stored.contrast;
+    if (known & LCD_KNOWN_SPLASH) device.splash_on = stored.splash_on;
+    if (known & LCD_KNOWN_MESSAGES) device.messages_on = stored.messages_on;
+    device.known |= known;
+    return ESP_OK;
+}
+
+esp_err_t LcdSettings::save_persistent()
+{
+    LcdPersistent stored = {};
+    {
+        std::lock_guard<std::mutex> guard(_panel.lock);
+        const LcdDeviceState &device = _panel.device;
+        stored.known = device.known & LCD_KNOWN_PERSISTENT;
+        stored.contrast = device.contrast;
+        stored.splash_on = device.splash_on;
+        stored.messages_on = device.messages_on;
+    }
+    char key[8];
+    persistent_key(_panel, key, sizeof(key));
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(LCD_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err != ESP_OK) return err;
+    LcdPersistent old;
+    size_t size = sizeof(old);
+    if (nvs_get_blob(nvs, key, &old, &size) == ESP_OK && size == sizeof(old) && memcmp(&old, &stored, sizeof(old)) == 0) {
+        nvs_close(nvs); // unchanged; spare the flash
+        return ESP_OK;
+    }
+    err = nvs_set_blob(nvs, key, &stored, sizeof(stored));
+    if (err == ESP_OK) err = nvs_commit(nvs);
+    nvs_close(nvs);
+    return err;
+}
+
+esp_err_t LcdSettings::forget_persistent()
+{
+    char key[8];
+    persistent_key(_panel, key, sizeof(key));
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(LCD_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err != ESP_OK) return err;
+    err = nvs_erase_key(nvs, key);
+    if (err == ESP_OK) err = nvs_commit(nvs);
+    nvs_close(nvs);
+    return err == ESP_ERR_NVS_NOT_FOUND ? ESP_OK : err;
+}
+
+#else
+
+esp_err_t LcdSettings::restore_persistent() { return ESP_ERR_NOT_SUPPORTED; }
+esp_err_t LcdSettings::save_persistent() { return ESP_ERR_NOT_SUPPORTED; }
+esp_err_t LcdSettings::forget_persistent() { return ESP_ERR_NOT_SUPPORTED; }
+
+#endif
@@ -0,0 +1,127 @@
+/**
+ * @file lcd_settings.h
+ * @brief Settings cache: device settings are only sent when they differ from what the
+ *        panel is known to have.
+ *
+ * Commands are queued on the panel (LcdPanel::send()) and go out ahead of the next
+ * frame's cell updates. If one fails or is cancelled, its setting becomes unknown and
+ * the next frame sends it again (restore()), so the display ends up as the application
+ * last asked for.
+ *
+ * Contrast, splash and system messages live in the SerLCD's EEPROM and survive a power
+ * cycle, but the cache does not. save_persistent() records them in NVS once they were
+ * acknowledged, and restore_persistent() marks them known again at the next cold boot so
+ * they are not rewritten (and the EEPROM not worn) every time the board starts. If the
+ * display is swapped, call forget_persistent().
+ *
+ * The firmware answers setting changes with a system message ("Contrast: 5") that
+ * blocks it for a while and overwrites the screen. Unless the application asked for
+ * them with set_messages(true), settings that trigger one first turn system messages
+ * off. That is an EEPROM setting too, so it is sent once per display, not per change.
+ */
+#pragma once
+
+#include "lcd_panel.h"
+
+#define LCD_SETTING_CONTRAST       0x18 /*!< '|' ctrl-x n: contrast, EEPROM */
+#define LCD_SETTING_RGB            0x2B /*!< '|' '+' r g b: backlight, not written to EEPROM */
+#define LCD_SETTING_SPLASH_ON      0x30 /*!< '|' ctrl-0: show the splash screen at power-up, EEPROM */
+#define LCD_SETTING_SPLASH_OFF     0x31 /*!< '|' ctrl-1 */
+#define LCD_SETTING_MESSAGES_ON    0x2E /*!< '|' '.': show system messages on setting changes, EEPROM */
+#define LCD_SETTING_MESSAGES_OFF   0x2F /*!< '|' '/' */
+#define LCD_MESSAGE_SETTLE_MS      500  /*!< how long the firmware shows a system message */
+
+#define LCD_KNOWN_PERSISTENT (LCD_KNOWN_CONTRAST | LCD_KNOWN_SPLASH | LCD_KNOWN_MESSAGES) /*!< stored in the SerLCD EEPROM */
+
+#define LCD_HD44780_DISPLAY_CONTROL 0x08
+#define LCD_HD44780_DISPLAY_ON      0x04
+
+class LcdSettings {
+public:
+    explicit LcdSettings(LcdPanel &panel) : _panel(panel) {}
+
+    /**
+     * @brief Backlight colour through the fast, non-persistent RGB command.
+     * @return true if a command was queued
+     */
+    bool set_backlight_fast(uint8_t red, uint8_t green, uint8_t blue);
+
+    /**
+     * @brief Turn the display (not the backlight) on or off. DDRAM is kept while off.
+     * @return true if a command was queued
+     */
+    bool set_display(bool on);
+
+    /**
+     * @brief Contrast, 0 (darkest) to 255. Written to EEPROM by the firmware. System
+     *        messages are turned off first, see set_messages().
+     * @return true if a command was queued
+     */
+    bool set_contrast(uint8_t contrast);
+
+    /**
+     * @brief Show the splash screen at power-up. With it off, the firmware accepts data
+     *        as soon as it boots (see lcd_wait_ready()).
+     * @return true if a command was queued
+     */
+    bool set_splash(bool on);
+
+    /**
+     * @brief Load @p count glyphs into CGRAM slots @p first_slot and up.
+     *
+     * Slots that already hold the glyph are skipped; the rest are packed three to a
+     * transaction (a create-char command is 10 bytes), so a full set of 8 costs three
+     * writes instead of eight. Glyphs past the last slot are ignored.
+     * @return number of slots queued for loading
+     */
+    size_t load_glyphs(const LcdGlyph *glyphs, size_t count, uint8_t first_slot = 0);
+
+    /**
+     * @brief Load the glyphs of one page of a slot table generated by tools/glyph_slots.
+     * @param glyphs every glyph of the UI, indexed by glyph id
+     * @param page   glyph id per CGRAM slot, LCD_GLYPH_NONE for slots the page does not use
+     * @return number of slots queued for loading
+     */
+    size_t load_glyph_page(const LcdGlyph *glyphs, const uint8_t page[LCD_CGRAM_SLOTS]);
+
+    /**
+     * @brief Show firmware system messages on setting changes. Off by default: the first
+     *        setting that would trigger one turns them off. Turning them on opts out of
+     *        that, and every such setting then costs a full redraw.
+     * @return true if a command was queued
+     */
+    bool set_messages(bool on);
+
+    /**
+     * @brief Mark the EEPROM settings recorded in NVS for this panel's address as known.
+     * @return ESP_ERR_NOT_FOUND if nothing was recorded, ESP_ERR_NOT_SUPPORTED on the host
+     */
+    esp_err_t restore_persistent();
+
+    /**
+     * @brief Record the EEPROM settings the panel currently knows. Call once the queue is
+     *        empty, so only acknowledged settings are recorded.
+     */
+    esp_err_t save_persistent();
+
+    esp_err_t forget_persistent();
+
+    /**
+     * @brief Resend the settings and glyphs the application set whose command failed,
+     *        was cancelled at a frame deadline or was lost with a brownout. Called by
+     *        LcdPanel::plan(), which holds the panel lock.
+     */
+    static void restore(LcdPanel &panel);
+
+private:
+    // caller holds the panel lock; each sends the value in panel.device
+    static void send_backlight(LcdPanel &panel);
+    static void send_display(LcdPanel &panel);
+    static void send_contrast(LcdPanel &panel);
+    static void send_splash(LcdPanel &panel);
+    static void send_messages(LcdPanel &panel);
+    static uint16_t before_message(LcdPanel &panel); // returns the settle time
+    size_t load_slots(const LcdGlyph *const slots[LCD_CGRAM_SLOTS]); // nullptr keeps a slot
+
+    LcdPanel &_panel;
+};
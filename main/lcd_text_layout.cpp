@@ -0,0 +1,78 @@
+#include <string.h>
+
+#include "lcd_text_layout.h"
+
+LcdTextLayout::LcdTextLayout(LcdRegion *region) : _region(region) {}
+
+void LcdTextLayout::set_text(const char *text)
+{
+    size_t len = strnlen(text, LCD_TEXT_MAX);
+    if (_text && len == _len && memcmp(text, _text.get(), len) == 0) return;
+    _text.reset(new char[len ? len : 1]);
+    memcpy(_text.get(), text, len);
+    _len = len;
+    layout();
+    _shown = false;
+    show_page(0);
+}
+
+void LcdTextLayout::layout()
+{
+    const char *text = _text.get();
+    const size_t width = _region->width();
+    _lines.clear();
+    size_t pos = 0;
+    bool wrapped = false; // soft break before pos: drop its leading spaces
+    while (pos < _len) {
+        if (wrapped) {
+            while (pos < _len && text[pos] == ' ') pos++;
+            if (pos == _len) break;
+        }
+        size_t end = pos;
+        size_t space = 0; // last break opportunity on this line, 0 for none
+        while (end < _len && end - pos < width && text[end] != '\n') {
+            if (text[end] == ' ') space = end;
+            end++;
+        }
+        size_t next;
+        if (end == _len || text[end] == '\n') {
+            next = end + 1;
+            wrapped = false;
+        } else if (text[end] == ' ' || space <= pos) {
+            next = end; // the word ends at the edge, or is wider than the region
+            wrapped = true;
+        } else {
+            end = space;
+            next = space + 1;
+            wrapped = true;
+        }
+        _lines.push_back({(uint16_t)pos, (uint8_t)(end - pos)});
+        pos = next;
+    }
+    size_t height = _region->height();
+    size_t pages = (_lines.size() + height - 1) / height;
+    _pages = pages == 0 ? 1 : pages > 0xFF ? 0xFF : (uint8_t)pages;
+}
+
+void LcdTextLayout::show_page(uint8_t page)
+{
+    page %= _pages;
+    if (_shown && page == _page) return;
+    size_t first = (size_t)page * _region->height();
+    for (uint8_t row = 0; row < _region->height(); row++) {
+        size_t line = first + row;
+        if (line < _lines.size()) {
+            _region->put_padded(row, &_text[_lines[line].start], _lines[line].len);
+        } else {
+            _region->put_padded(row, "");
+        }
+    }
+    _page = page;
+    _shown = true;
+}
+
+uint8_t LcdTextLayout::next_page()
+{
+    show_page((uint8_t)((_page + 1) % _pages));
+    return _page;
+}
@@ -0,0 +1,53 @@
+/**
+ * @file lcd_text_layout.h
+ * @brief Word-wrapped, paged text in a region, e.g. alarm messages or network status.
+ *
+ * set_text() breaks the message into region-wide lines once and keeps the line table;
+ * calling it again with the same text costs a compare. A page is region-height lines of
+ * that table. Pages are written whole into the region, and the diff engine sends only
+ * the cells that differ from the page on the display, so a flip between two similar
+ * pages (a shared heading, a long word that stays put) costs a handful of bytes.
+ *
+ * Lines break at spaces, spaces at the start of a wrapped line are dropped, '\n' forces
+ * a break and words longer than the region are split. Like the region, a layout has one
+ * writer and takes no lock.
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "lcd_region.h"
+
+#define LCD_TEXT_MAX 0xFFFF /*!< longer messages are cut */
+
+struct LcdTextLine {
+    uint16_t start; /*!< offset into the message */
+    uint8_t len;
+};
+
+class LcdTextLayout {
+public:
+    explicit LcdTextLayout(LcdRegion *region);
+
+    /**
+     * @brief Show @p text from its first page. Same text as before: no change.
+     */
+    void set_text(const char *text);
+
+    uint8_t pages() const { return _pages; }
+    uint8_t page() const { return _page; }
+    void show_page(uint8_t page); // wraps around past the last page
+    uint8_t next_page(); // returns the page now shown
+
+private:
+    void layout();
+
+    LcdRegion *_region;
+    std::unique_ptr<char[]> _text;
+    size_t _len = 0;
+    std::vector<LcdTextLine> _lines; /*!< break table of the current text */
+    uint8_t _pages = 1;
+    uint8_t _page = 0;
+    bool _shown = false; /*!< _page is in the region */
+};
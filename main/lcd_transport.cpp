@@ -0,0 +1,164 @@
+#include "lcd_transport.h"
+#include "lcd_settings.h"
+
+esp_err_t lcd_wait_ready(LcdTransport &transport, uint8_t addr, uint32_t timeout_ms)
+{
+    int64_t give_up = lcd_now_us() + (int64_t)timeout_ms * 1000;
+    uint32_t backoff_ms = LCD_READY_POLL_MIN_MS;
+    while (transport.probe(addr, LCD_READY_POLL_MIN_MS) != ESP_OK) {
+        if (lcd_now_us() >= give_up) return ESP_ERR_TIMEOUT;
+        lcd_delay_ms(backoff_ms);
+        if (backoff_ms < LCD_READY_POLL_MAX_MS) backoff_ms *= 2;
+    }
+    return ESP_OK;
+}
+
+#define LCD_PCF8574_SLOW_MS 2 /*!< clear and return home take 1.52 ms */
+
+void LcdPcf8574Transport::nibble(uint8_t bits)
+{
+    _out[_len++] = bits | LCD_PCF8574_EN;
+    _out[_len++] = bits; // the controller latches on the falling edge
+}
+
+void LcdPcf8574Transport::put(uint8_t byte, bool data)
+{
+    uint8_t bits = (uint8_t)((_bits & LCD_PCF8574_BL) | (data ? LCD_PCF8574_RS : 0));
+    if (_rs != (int)data) {
+        _out[_len++] = bits; // RS settles before the first enable
+        _rs = data;
+    }
+    nibble((uint8_t)(bits | (byte & 0xF0)));
+    nibble((uint8_t)(bits | (byte << 4)));
+}
+
+esp_err_t LcdPcf8574Transport::flush(uint8_t addr, uint32_t timeout_ms)
+{
+    if (_len == 0) return ESP_OK;
+    uint32_t wire_ms = (uint32_t)(((_len + 1) * 9000 + _bus_hz - 1) / _bus_hz);
+    esp_err_t err = _bus.write(addr, _out, _len, timeout_ms + wire_ms);
+    _len = 0;
+    if (err != ESP_OK) lost(addr);
+    return err;
+}
+
+esp_err_t LcdPcf8574Transport::wake(uint8_t addr)
+{
+    // 8-bit function set three times, then 4-bit: works from any state the controller is in
+    static const uint8_t wake[] = {0x30, 0x30, 0x30, 0x20};
+    static const uint32_t wait_ms[] = {5, 1, 1, 1};
+    uint8_t bit = (uint8_t)(1 << (addr % 8));
+    _lost[addr / 8] &= (uint8_t)~bit;
+    _bits = (_dark[addr / 8] & bit) ? 0 : LCD_PCF8574_BL;
+    _rs = -1;
+    for (size_t i = 0; i < sizeof(wake); i++) {
+        _len = 0;
+        nibble((uint8_t)(_bits | wake[i]));
+        esp_err_t err = flush(addr, LCD_TIMEOUT_COMMAND_MS);
+        if (err != ESP_OK) return err;
+        lcd_delay_ms(wait_ms[i]);
+    }
+    uint8_t control = (_blank[addr / 8] & bit) ? 0x08 : 0x0C; // display on unless turned off, no cursor
+    const uint8_t setup[] = {LCD_CMD_SPECIAL, 0x28,     // 4-bit, 2 lines, 5x8
+                             LCD_CMD_SPECIAL, control,
+                             LCD_CMD_SPECIAL, 0x06};    // increment, no display shift
+    return write(addr, setup, sizeof(setup), LCD_TIMEOUT_COMMAND_MS);
+}
+
+esp_err_t LcdPcf8574Transport::init(uint8_t addr)
+{
+    addr &= 0x7F;
+    _blank[addr / 8] &= (uint8_t)~(1 << (addr % 8));
+    esp_err_t err = wake(addr);
+    const uint8_t clear[] = {LCD_CMD_SPECIAL, 0x01};
+    return err == ESP_OK ? write(addr, clear, sizeof(clear), LCD_TIMEOUT_COMMAND_MS) : err;
+}
+
+esp_err_t LcdPcf8574Transport::probe(uint8_t addr, uint32_t timeout_ms)
+{
+    esp_err_t err = _bus.probe(addr, timeout_ms);
+    if (err != ESP_OK) lost(addr);
+    return err;
+}
+
+esp_err_t LcdPcf8574Transport::write(uint8_t addr, const uint8_t *data, size_t len, uint32_t timeout_ms)
+{
+    addr &= 0x7F;
+    uint8_t dark = (uint8_t)(1 << (addr % 8));
+    if (_lost[addr / 8] & dark) {
+        esp_err_t err = wake(addr); // the controller may be back in 8-bit mode
+        if (err != ESP_OK) return err;
+    }
+    _bits = (_dark[addr / 8] & dark) ? 0 : LCD_PCF8574_BL;
+    _rs = -1;
+    _len = 0;
+    esp_err_t err = ESP_OK;
+    for (size_t i = 0; i < len && err == ESP_OK; i++) {
+        if (_len + 10 > sizeof(_out)) err = flush(addr, timeout_ms);
+        uint8_t c = data[i];
+        bool slow = false;
+        if (c == LCD_CMD_SPECIAL && i + 1 < len) {
+            uint8_t cmd = data[++i];
+            put(cmd, false);
+            if ((cmd & 0xF8) == LCD_HD44780_DISPLAY_CONTROL) {
+                _blank[addr / 8] = (cmd & LCD_HD44780_DISPLAY_ON) ? (uint8_t)(_blank[addr / 8] & ~dark)
+                                                                 : (uint8_t)(_blank[addr / 8] | dark);
+            }
+            slow = cmd == 0x01 || (cmd & 0xFE) == LCD_CMD_HOME;
+        } else if (c == LCD_CMD_SETTING && i + 1 < len) {
+            uint8_t setting = data[++i];
+            if (setting == LCD_SETTING_CLEAR) {
+                put(0x01, false);
+                slow = true;
+            } else if (setting >= LCD_CMD_CUSTOM_CHAR && setting < LCD_CMD_CUSTOM_CHAR + 8) {
+                put((uint8_t)(setting - LCD_CMD_CUSTOM_CHAR), true);
+            } else if (setting >= LCD_SETTING_CREATE_CHAR && setting < LCD_SETTING_CREATE_CHAR + 8 && i + 8 < len) {
+                put((uint8_t)(0x40 | (setting - LCD_SETTING_CREATE_CHAR) << 3), false); // CGRAM address
+                for (int row = 0; row < 8; row++) {
+                    if (_len + 10 > sizeof(_out)) err = flush(addr, timeout_ms);
+                    put(data[++i], true);
+                }
+            } else if (setting == LCD_SETTING_RGB && i + 3 < len) {
+                bool on = data[i + 1] | data[i + 2] | data[i + 3];
+                i += 3;
+                _bits = on ? (uint8_t)(_bits | LCD_PCF8574_BL) : (uint8_t)(_bits & ~LCD_PCF8574_BL);
+                _dark[addr / 8] = on ? (uint8_t)(_dark[addr / 8] & ~dark) : (uint8_t)(_dark[addr / 8] | dark);
+                _out[_len++] = (uint8_t)(_bits | (_rs > 0 ? LCD_PCF8574_RS : 0));
+            } else if (setting == LCD_SETTING_CONTRAST && i + 1 < len) {
+                i++; // a trimmer on the backpack
+            }
+        } else {
+            put(c, true);
+        }
+        if (slow && err == ESP_OK) {
+            err = flush(addr, timeout_ms);
+            lcd_delay_ms(LCD_PCF8574_SLOW_MS);
+        }
+    }
+    if (err == ESP_OK) err = flush(addr, timeout_ms);
+    _len = 0;
+    return err;
+}
+
+#ifdef ESP_PLATFORM
+
+esp_err_t LcdI2cTransport::write(uint8_t addr, const uint8_t *data, size_t len, uint32_t timeout_ms)
+{
+    TickType_t ticks = pdMS_TO_TICKS(timeout_ms);
+    return i2c_master_write_to_device(_port, addr, data, len, ticks ? ticks : 1); // never 0 at low tick rates
+}
+
+esp_err_t LcdI2cTransport::probe(uint8_t addr, uint32_t timeout_ms)
+{
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    if (!cmd) return ESP_ERR_NO_MEM;
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (uint8_t)(addr << 1) | I2C_MASTER_WRITE, true);
+    i2c_master_stop(cmd);
+    TickType_t ticks = pdMS_TO_TICKS(timeout_ms);
+    esp_err_t err = i2c_master_cmd_begin(_port, cmd, ticks ? ticks : 1);
+    i2c_cmd_link_delete(cmd);
+    return err;
+}
+
+#endif
@@ -0,0 +1,141 @@
+/**
+ * @file lcd_transport.h
+ * @brief Byte transports that carry encoded transactions to a display.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lcd_port.h"
+
+#ifdef ESP_PLATFORM
+#include "driver/i2c.h"
+#endif
+
+class LcdTransport {
+public:
+    virtual ~LcdTransport() {}
+
+    /**
+     * @brief Write one transaction to the display at @p addr.
+     * @return ESP_OK when the device acknowledged every byte
+     */
+    virtual esp_err_t write(uint8_t addr, const uint8_t *data, size_t len, uint32_t timeout_ms) = 0;
+
+    /**
+     * @brief Address-only transfer: is anything acknowledging @p addr?
+     */
+    virtual esp_err_t probe(uint8_t addr, uint32_t timeout_ms) = 0;
+};
+
+#define LCD_READY_POLL_MIN_MS 1  /*!< first retry after a NACK */
+#define LCD_READY_POLL_MAX_MS 16 /*!< backoff cap; bounds how late the first frame can start */
+
+/**
+ * @brief Wait until the display at @p addr acknowledges its address.
+ *
+ * Replaces fixed power-on delays: the first frame can go out as soon as the firmware is
+ * listening. Retries back off from LCD_READY_POLL_MIN_MS to LCD_READY_POLL_MAX_MS.
+ * @return ESP_OK once acknowledged, ESP_ERR_TIMEOUT after @p timeout_ms
+ */
+esp_err_t lcd_wait_ready(LcdTransport &transport, uint8_t addr, uint32_t timeout_ms);
+
+#ifdef ESP_PLATFORM
+/**
+ * @brief Transport over an I2C port that the application has already installed.
+ */
+class LcdI2cTransport : public LcdTransport {
+public:
+    explicit LcdI2cTransport(i2c_port_t port) : _port(port) {}
+
+    esp_err_t write(uint8_t addr, const uint8_t *data, size_t len, uint32_t timeout_ms) override;
+    esp_err_t probe(uint8_t addr, uint32_t timeout_ms) override;
+
+private:
+    i2c_port_t _port;
+};
+#endif
+
+#define LCD_PCF8574_RS 0x01 /*!< backpack wiring: P0 register select */
+#define LCD_PCF8574_EN 0x04 /*!< P2 enable; P1 (R/W) stays low */
+#define LCD_PCF8574_BL 0x08 /*!< P3 backlight transistor */
+#define LCD_PCF8574_CHUNK 160 /*!< expander bytes per I2C write */
+
+/**
+ * @brief HD44780 with a PCF8574 I2C backpack behind the SerLCD byte protocol.
+ *
+ * Translates what the engine encodes for a SerLCD into 4-bit HD44780 bus cycles on
+ * the expander, so frames, diffs, cursor tracking and batching are shared by both
+ * kinds of display. Each character is two nibbles of an enable-high and an enable-low
+ * byte; a transaction goes out as one I2C write of those sequences (clear and return
+ * home are followed by a 2 ms pause, so they end a write).
+ *
+ * Understood: text, custom characters ('|' 35+n), '|' '-' clear, '|' 27+n CGRAM loads
+ * (to RAM here, nothing is persisted), the '|' '+' backlight (on unless all zero) and
+ * raw HD44780 commands after 0xFE. Other SerLCD settings are dropped. The controller
+ * does not move to the next row at the end of one; the engine never relies on that.
+ *
+ * Unlike the SerLCD firmware, the controller comes back from a power loss in 8-bit
+ * mode, and would take every 4-bit nibble after that for a command. So after any
+ * transfer to an address fails, the next write to it first runs the initialization
+ * sequence again, without the clear; the engine's own recovery redraws the screen.
+ */
+class LcdPcf8574Transport : public LcdTransport {
+public:
+    /**
+     * @param bus transport to the I2C port the backpack is on
+     * @param bus_hz bus clock: a transaction is about four times as many bytes here,
+     *        so the extra wire time is added to each write's timeout
+     */
+    explicit LcdPcf8574Transport(LcdTransport &bus, uint32_t bus_hz = 100000) : _bus(bus), _bus_hz(bus_hz) {}
+
+    /**
+     * @brief Power-on initialization by instruction: 4-bit, 2-line mode, display on,
+     *        cleared. Call once the backpack acknowledges, before the first frame.
+     */
+    esp_err_t init(uint8_t addr);
+
+    esp_err_t write(uint8_t addr, const uint8_t *data, size_t len, uint32_t timeout_ms) override;
+    esp_err_t probe(uint8_t addr, uint32_t timeout_ms) override;
+
+private:
+    esp_err_t wake(uint8_t addr); // initialization by instruction, without the clear
+    void lost(uint8_t addr) { _lost[(addr & 0x7F) / 8] |= (uint8_t)(1 << (addr % 8)); }
+    void put(uint8_t byte, bool data);
+    void nibble(uint8_t bits);
+    esp_err_t flush(uint8_t addr, uint32_t timeout_ms);
+
+    LcdTransport &_bus;
+    uint32_t _bus_hz;
+    uint8_t _out[LCD_PCF8574_CHUNK];
+    size_t _len = 0;
+    uint8_t _bits = 0;        /*!< RS and backlight of the byte being written */
+    int _rs = -1;             /*!< RS level on the expander, -1 at the start of a write */
+    uint8_t _dark[128 / 8] = {}; /*!< bit per address: backlight off */
+    uint8_t _blank[128 / 8] = {}; /*!< bit per address: display off (HD44780 display control) */
+    uint8_t _lost[128 / 8] = {}; /*!< bit per address: a transfer failed; wake() before the next write */
+};
+
+/**
+ * @brief Transport that only counts bytes. Used by the host benchmarks.
+ */
+class LcdNullTransport : public LcdTransport {
+public:
+    esp_err_t write(uint8_t addr, const uint8_t *data, size_t len, uint32_t timeout_ms) override
+    {
+        (void)addr; (void)data; (void)timeout_ms;
+        bytes += len;
+        writes++;
+        return ESP_OK;
+    }
+
+    esp_err_t probe(uint8_t addr, uint32_t timeout_ms) override
+    {
+        (void)addr; (void)timeout_ms;
+        return ESP_OK;
+    }
+
+    size_t bytes = 0;
+    size_t writes = 0;
+};
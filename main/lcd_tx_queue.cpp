@@ -0,0 +1,102 @@
+#include "lcd_tx_queue.h"
+#include "lcd_panel.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_pthread.h"
+#endif
+
+void LcdTxQueue::start()
+{
+    if (_thread.joinable()) return;
+    _stop = false;
+    _pm.init("lcd_tx");
+#ifdef ESP_PLATFORM
+    esp_pthread_cfg_t caller; // put back below, or the caller's later threads would be lcd_tx too
+    if (esp_pthread_get_cfg(&caller) != ESP_OK) caller = esp_pthread_get_default_config();
+    esp_pthread_cfg_t cfg = esp_pthread_get_default_config();
+    cfg.thread_name = "lcd_tx";
+    cfg.prio = 5;
+    esp_pthread_set_cfg(&cfg);
+#endif
+    _thread = std::thread(&LcdTxQueue::drain, this);
+#ifdef ESP_PLATFORM
+    esp_pthread_set_cfg(&caller);
+#endif
+}
+
+void LcdTxQueue::stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _stop = true;
+    }
+    _ready.notify_all();
+    if (_thread.joinable()) _thread.join();
+}
+
+void LcdTxQueue::push(const LcdTransaction *txs, size_t count)
+{
+    if (count == 0) return;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _queue.insert(_queue.end(), txs, txs + count);
+    }
+    _ready.notify_one();
+}
+
+void LcdTxQueue::wait_empty()
+{
+    std::unique_lock<std::mutex> guard(_lock);
+    _empty.wait(guard, [this] { return _queue.empty() && !_busy; });
+}
+
+void LcdTxQueue::drain()
+{
+    std::unique_lock<std::mutex> guard(_lock);
+    while (true) {
+        if (_queue.empty()) _pm.release(); // let the chip sleep until the next frame
+        _ready.wait(guard, [this] { return _stop || !_queue.empty(); });
+        if (_queue.empty()) break; // stopped and drained
+        _pm.acquire();
+
+        LcdTransaction tx = _queue.front();
+        _queue.pop_front();
+        _busy = true;
+        guard.unlock();
+
+        LcdPanel *panel = static_cast<LcdPanel *>(tx.owner);
+        esp_err_t err = ESP_ERR_INVALID_STATE;
+        if (!panel || !panel->skipping()) {
+            // 9 bit times per byte plus the address byte, rounded up
+            uint32_t timeout_ms = tx.timeout_ms + ((tx.len + 1) * 9000 + _bus_hz - 1) / _bus_hz;
+            if (tx.deadline_us) {
+                int64_t left_ms = (tx.deadline_us - lcd_now_us()) / 1000;
+                if (left_ms <= 0) {
+                    err = ESP_ERR_NOT_FINISHED;
+                } else if (left_ms < timeout_ms) {
+                    timeout_ms = (uint32_t)left_ms;
+                }
+            }
+            if (err != ESP_ERR_NOT_FINISHED) {
+                err = tx.len ? _transport.write(tx.addr, tx.bytes, tx.len, timeout_ms)
+                             : _transport.probe(tx.addr, timeout_ms);
+                lcd_delay_ms(tx.settle_ms);
+            }
+        }
+        if (panel) panel->complete(tx, err);
+
+        guard.lock();
+        _busy = false;
+        if (err == ESP_OK) {
+            _sent.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            _failed.fetch_add(1, std::memory_order_relaxed);
+            if (err == ESP_ERR_TIMEOUT) _timeouts.fetch_add(1, std::memory_order_relaxed);
+            if (err == ESP_ERR_NOT_FINISHED) _cancelled.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (_queue.empty()) _empty.notify_all();
+    }
+    _busy = false;
+    _pm.release();
+    _empty.notify_all();
+}
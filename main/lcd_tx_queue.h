@@ -0,0 +1,55 @@
+/**
+ * @file lcd_tx_queue.h
+ * @brief Per-port transmit queue. One drain thread owns each bus.
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "lcd_frame.h"
+#include "lcd_pm.h"
+#include "lcd_transport.h"
+
+class LcdTxQueue {
+public:
+    /**
+     * @param bus_hz bus clock, used to add each write's wire time to its timeout budget
+     */
+    explicit LcdTxQueue(LcdTransport &transport, uint32_t bus_hz = 100000) : _transport(transport), _bus_hz(bus_hz) {}
+    ~LcdTxQueue() { stop(); }
+
+    void start(); // spawn the drain thread
+    void stop();  // drain what is queued, then join
+
+    void push(const LcdTransaction *txs, size_t count);
+    void wait_empty();
+
+    size_t sent() const { return _sent.load(std::memory_order_relaxed); }
+    size_t failed() const { return _failed.load(std::memory_order_relaxed); }       // all writes that did not complete
+    size_t timeouts() const { return _timeouts.load(std::memory_order_relaxed); }   // writes that ran out of their budget
+    size_t cancelled() const { return _cancelled.load(std::memory_order_relaxed); } // writes dropped at their frame deadline
+    float awake_fraction() const { return _pm.held_fraction(); } // time the bus kept the chip awake
+
+private:
+    void drain();
+
+    LcdTransport &_transport;
+    const uint32_t _bus_hz;
+    std::mutex _lock;
+    std::condition_variable _ready;
+    std::condition_variable _empty;
+    std::deque<LcdTransaction> _queue;
+    std::thread _thread;
+    LcdPmLock _pm; /*!< owned by the drain thread */
+    bool _busy = false;
+    bool _stop = false;
+    // written by the drain thread, read by anyone
+    std::atomic<size_t> _sent{0};
+    std::atomic<size_t> _failed{0};
+    std::atomic<size_t> _timeouts{0};
+    std::atomic<size_t> _cancelled{0};
+};
@@ -7,9 +7,19 @@
 
 // esp-idf drivers
 #include "driver/i2c.h"
+#include "esp_pm.h"
+#include "nvs_flash.h"
+#include "soc/soc_caps.h"
 
 #include "SerLCD.h"
 
+#include "lcd_clock_widget.h"
+#include "lcd_panel.h"
+#include "lcd_render_pool.h"
+#include "lcd_rtc_state.h"
+#include "lcd_settings.h"
+#include "lcd_transport.h"
+
 static const char *TAG = "SerLCD example";
 
 #define I2C_CLIENT_SCL_IO  GPIO_NUM_16 /*!< GPIO number used for I2C client clock */
@@ -19,9 +29,40 @@ i2c_port_t i2c_client_num = 1;                        /*!< I2C master i2c port n
 #define I2C_CLIENT_FREQ_HZ 50000               /*!< I2C master clock frequency */ //320000 too fast for the AIP display
 #define I2C_CLIENT_TX_BUF_DISABLE 0             /*!< I2C master doesn't need buffer */
 #define I2C_CLIENT_RX_BUF_DISABLE 0             /*!< I2C master doesn't need buffer */
-#define I2C_CLIENT_TIMEOUT_MS 1000
+#if CONFIG_I2C_ISR_IRAM_SAFE
+#define I2C_CLIENT_INTR_FLAGS ESP_INTR_FLAG_IRAM /*!< keep transferring while the flash cache is disabled */
+#else
+#define I2C_CLIENT_INTR_FLAGS 0
+#endif
+#if CONFIG_PM_ENABLE && (SOC_I2C_SUPPORT_REF_TICK || SOC_I2C_SUPPORT_XTAL)
+#define I2C_CLIENT_CLK_FLAGS I2C_SCLK_SRC_FLAG_AWARE_DFS /*!< REF_TICK/XTAL source; stays put when DFS lowers APB */
+#else
+#define I2C_CLIENT_CLK_FLAGS 0 /*!< APB source; the transmit queue holds APB at max while it transfers */
+#endif
+
+#if CONFIG_EXAMPLE_LCD_PCF8574
+#define LCD_I2C_ADDRESS CONFIG_EXAMPLE_PCF8574_ADDRESS
+#define LCD_COLS 16
+#define LCD_ROWS 2
+#else
+#define LCD_I2C_ADDRESS 0x72 /*!< default SerLCD address */
+#define LCD_COLS 20
+#define LCD_ROWS 4
+#endif
+#define LCD_CLOCK_LEAD_US 5000 /*!< a short frame takes a few ms at 50 kHz, so tick that much early */
+#define LCD_READY_TIMEOUT_MS 3000 /*!< covers the splash screen of a display that still has it enabled */
+#define LCD_PM_REPORT_US (60 * 1000000LL) /*!< how often to log the share of time the display kept the chip awake */
+
+#if !CONFIG_EXAMPLE_LCD_PCF8574
+SerLCD lcd; // the library; sets up a display this board has not seen before
+#endif
+
+static TaskHandle_t render_task; /*!< task that owns the render loop in app_main */
 
-SerLCD lcd; // Initialize the library with default I2C address 0x72
+static void wake_renderer(void *ctx)
+{
+    xTaskNotifyGive(render_task);
+}
 
 
 /**
@@ -36,12 +77,12 @@ static esp_err_t i2c_client_init(void)
         .sda_pullup_en = GPIO_PULLUP_DISABLE, //.sda_pullup_en
         .scl_pullup_en = GPIO_PULLUP_DISABLE, //.scl_pullup_en
         .master = {.clk_speed = I2C_CLIENT_FREQ_HZ}, //.master.clk_speed
-        .clk_flags = 0//  =  default clock TEST
+        .clk_flags = I2C_CLIENT_CLK_FLAGS
     };
 
     ESP_ERROR_CHECK(i2c_param_config(i2c_client_num, &conf));
 
-    return i2c_driver_install(i2c_client_num, conf.mode, I2C_CLIENT_RX_BUF_DISABLE, I2C_CLIENT_TX_BUF_DISABLE, 0);
+    return i2c_driver_install(i2c_client_num, conf.mode, I2C_CLIENT_RX_BUF_DISABLE, I2C_CLIENT_TX_BUF_DISABLE, I2C_CLIENT_INTR_FLAGS);
 }
 
 extern "C" void app_main(void)
@@ -51,18 +92,93 @@ extern "C" void app_main(void)
     ESP_LOGI(TAG, "I2C initialized successfully");
     ESP_LOGI(TAG, "portTICK_PERIOD_MS: %li", portTICK_PERIOD_MS);
 
-  lcd.begin(i2c_client_num); //Set up the LCD for I2C communication
+    esp_err_t nvs_err = nvs_flash_init();
+    if (nvs_err == ESP_ERR_NVS_NO_FREE_PAGES || nvs_err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        nvs_err = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(nvs_err);
+
+#if CONFIG_PM_ENABLE
+    // Scale down and light-sleep whenever the transmit queue does not hold its lock
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = CONFIG_EXAMPLE_PM_MIN_CPU_FREQ_MHZ,
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+        .light_sleep_enable = true
+#endif
+    };
+    ESP_ERROR_CHECK(esp_pm_configure(&pm_config));
+#endif
+
+    static LcdI2cTransport i2c(i2c_client_num);
+#if CONFIG_EXAMPLE_LCD_PCF8574
+    static LcdPcf8574Transport transport(i2c, I2C_CLIENT_FREQ_HZ); // SerLCD protocol in, HD44780 nibbles out
+#else
+    LcdTransport &transport = i2c;
+#endif
+    static LcdTxQueue bus(transport, I2C_CLIENT_FREQ_HZ); // per-write timeouts scale with the bus speed
+    static LcdPanel panel(LCD_I2C_ADDRESS, 0, LCD_COLS, LCD_ROWS);
+    static LcdRenderPool renderer({&bus}, 1);
+    static LcdSettings settings(panel);
+    LcdPanel *panels[] = {&panel};
+
+    // After deep sleep the SerLCD still shows the last frame (see lcd_rtc_save()), so skip
+    // the clear and the redraw; only the values that changed since are sent.
+    if (lcd_rtc_restore(panel)) {
+        ESP_LOGI(TAG, "display state retained across deep sleep");
+    } else {
+        // No fixed power-on delays (SerLCD::begin() waits them out): start as soon as the
+        // display acknowledges, and skip the EEPROM settings it is known to have already
+        if (lcd_wait_ready(transport, LCD_I2C_ADDRESS, LCD_READY_TIMEOUT_MS) != ESP_OK) {
+            ESP_LOGW(TAG, "display not answering; the render engine keeps probing");
+        }
+        [[maybe_unused]] esp_err_t restored = settings.restore_persistent();
+#if CONFIG_EXAMPLE_LCD_PCF8574
+        ESP_ERROR_CHECK_WITHOUT_ABORT(transport.init(LCD_I2C_ADDRESS)); // no firmware on the backpack does this
+#else
+        if (restored == ESP_ERR_NOT_FOUND) {
+            // First boot with this display: the library's begin() brings it into its default
+            // state. Its power-on delays are paid once; later boots find the settings in NVS.
+            lcd.begin(i2c_client_num);
+        }
+#endif
+        panel.reset_display();
+    }
+    bus.start();
+
+    settings.set_splash(false); // once in EEPROM, the next power-up is ready without the splash screen
+    settings.set_backlight_fast(255, 255, 255); // bright white
+    settings.set_contrast(5); // lower to 0 for higher contrast
+
+    // From here on the render engine owns the screen: it only sends what changed
+    LcdRegion *greeting = panel.lease(0, 0, LCD_COLS, 1);
+    greeting->put(0, 0, "Hello, World!");
+
+    // Uptime on the second line; the widget ticks at each second boundary from an esp_timer
+    LcdRegion *uptime_region = panel.lease(0, 1, LCD_COLS, 1);
+    static LcdClockWidget uptime(uptime_region, 0, 0, LCD_CLOCK_HMS);
+    render_task = xTaskGetCurrentTaskHandle();
+    ESP_ERROR_CHECK(uptime.start(0, LCD_CLOCK_LEAD_US, wake_renderer, nullptr));
 
-  lcd.setBacklight(255, 255, 255); //Set backlight to bright white
-  lcd.setContrast(5); //Set contrast. Lower to 0 for higher contrast.
+    renderer.render(panels, 1);
+    bus.wait_empty();
+    ESP_LOGI(TAG, "first frame on the display %lld ms after boot", esp_timer_get_time() / 1000);
+    settings.save_persistent(); // only what was acknowledged
 
-  lcd.clear(); //Clear the display - this moves the cursor to home position as well
-  lcd.print("Hello, World!");
+    int64_t last_report = esp_timer_get_time();
     while (true){
-        // Set the cursor to column 0, line 1
-        // (note: line 1 is the second row, since counting begins with 0):
-        lcd.setCursor(0, 1);
-        // Print the number of seconds since reset:
-        lcd.print((uint32_t)(esp_timer_get_time() / 1000000));
+        renderer.render(panels, 1);
+        // sleep until something changed, or until blinking cells toggle
+        int64_t now = esp_timer_get_time();
+        int64_t deadline = panel.attr_deadline_us(now);
+        TickType_t wait = portMAX_DELAY;
+        if (deadline) wait = deadline > now ? pdMS_TO_TICKS((deadline - now) / 1000) + 1 : 1;
+        ulTaskNotifyTake(pdTRUE, wait);
+        if (esp_timer_get_time() - last_report >= LCD_PM_REPORT_US) {
+            last_report = esp_timer_get_time();
+            ESP_LOGI(TAG, "display bus held the PM lock %.2f%% of the time; %u timeouts, %u cancelled writes",
+                     100.0f * bus.awake_fraction(), (unsigned)bus.timeouts(), (unsigned)bus.cancelled());
+        }
     }
 }
\ No newline at end of file
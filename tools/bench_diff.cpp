@@ -0,0 +1,75 @@
+/**
+ * @file bench_diff.cpp
+ * @brief Host microbenchmark: word-wise diff kernel vs. byte-by-byte compare.
+ *
+ * Build and run on Linux from the repository root:
+ *
+ *     g++ -O2 -std=c++20 -Imain tools/bench_diff.cpp main/lcd_diff.cpp -o bench_diff
+ *     ./bench_diff
+ *
+ * For each screen size the benchmark changes a given number of cells per frame and
+ * times both kernels over the same buffers. The word-wise kernel also gets the per-row
+ * dirty mask, so it only visits the rows that were written.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <random>
+#include <vector>
+
+#include "lcd_diff.h"
+#include "lcd_port.h"
+
+struct Size {
+    uint8_t cols;
+    uint8_t rows;
+};
+
+static const Size sizes[] = {{16, 2}, {20, 4}, {40, 4}, {40, 8}, {80, 8}, {80, 16}};
+static const unsigned changes[] = {0, 1, 8, 64};
+
+int main()
+{
+    const size_t frames = 200000;
+    printf("%7s %8s %14s %14s %9s\n", "size", "changes", "bytewise ns", "wordwise ns", "speedup");
+    for (const Size &size : sizes) {
+        size_t stride = lcd_diff_stride(size.cols);
+        std::vector<uint8_t> target(stride * size.rows + LCD_DIFF_ALIGN, ' ');
+        std::vector<uint8_t> shadow(stride * size.rows + LCD_DIFF_ALIGN, ' ');
+        for (unsigned n : changes) {
+            std::mt19937 rng(42);
+            std::vector<LcdRun> runs;
+            runs.reserve(1024);
+            int64_t byte_us = 0, word_us = 0;
+            size_t byte_runs = 0, word_runs = 0;
+            for (size_t f = 0; f < frames; f++) {
+                uint64_t dirty = 0;
+                memcpy(shadow.data(), target.data(), shadow.size());
+                for (unsigned i = 0; i < n; i++) {
+                    uint8_t row = rng() % size.rows;
+                    target[row * stride + rng() % size.cols] = 'A' + rng() % 26;
+                    dirty |= (uint64_t)1 << row;
+                }
+
+                runs.clear();
+                int64_t t0 = lcd_now_us();
+                byte_runs += lcd_diff_bytewise(target.data(), shadow.data(), stride, size.cols, size.rows, runs);
+                int64_t t1 = lcd_now_us();
+                runs.clear();
+                word_runs += lcd_diff(target.data(), shadow.data(), stride, size.cols, size.rows, dirty, runs);
+                int64_t t2 = lcd_now_us();
+                byte_us += t1 - t0;
+                word_us += t2 - t1;
+            }
+            if (byte_runs != word_runs) {
+                fprintf(stderr, "run count mismatch: %zu vs %zu\n", byte_runs, word_runs);
+                return 1;
+            }
+            char name[16];
+            snprintf(name, sizeof(name), "%ux%u", size.cols, size.rows);
+            printf("%7s %8u %14.1f %14.1f %8.2fx\n", name, n, 1000.0 * byte_us / frames, 1000.0 * word_us / frames,
+                   word_us ? (double)byte_us / word_us : 0.0);
+        }
+    }
+    return 0;
+}
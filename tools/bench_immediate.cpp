@@ -0,0 +1,100 @@
+/**
+ * @file bench_immediate.cpp
+ * @brief Host benchmark: bus bytes of an immediate-mode UI vs. a hand-tracked retained one.
+ *
+ * Build and run on Linux from the repository root:
+ *
+ *     g++ -O2 -std=c++20 -pthread -Imain -Itools tools/bench_immediate.cpp main/lcd_*.cpp -o bench_immediate
+ *     ./bench_immediate
+ *
+ * Both panels show the same 20x4 status screen, where a counter ticks every frame and
+ * a status line changes now and then. The immediate-mode panel redraws every cell of
+ * it through the guard LcdPanel::frame_begin() returns. The retained panel writes only
+ * the fields whose value changed. Both drive an LcdEmulator, which must show the same
+ * screen after every frame.
+ */
+#include <stdio.h>
+
+#include "lcd_emulator.h"
+#include "lcd_render_pool.h"
+
+static const char *const states[] = {"idle", "heating", "cooling"};
+
+static void draw_static(LcdFrame &frame)
+{
+    frame.put(0, 0, "Boiler controller");
+    frame.put(0, 1, "Ticks");
+    frame.put(0, 2, "State");
+    frame.put(0, 3, "Setpoint   21.5 C");
+}
+
+static void draw_ticks(LcdFrame &frame, int tick)
+{
+    char text[16];
+    snprintf(text, sizeof(text), "%8d", tick);
+    frame.put(12, 1, text);
+}
+
+static void draw_state(LcdFrame &frame, int tick)
+{
+    char text[16];
+    snprintf(text, sizeof(text), "%-8s", states[tick / 25 % 3]);
+    frame.put(12, 2, text);
+}
+
+int main()
+{
+    const int frames = 200;
+    LcdEmulator immediate_lcd, retained_lcd;
+    LcdTxQueue immediate_bus(immediate_lcd), retained_bus(retained_lcd);
+    immediate_bus.start();
+    retained_bus.start();
+    LcdPanel immediate(0x72, 0), retained(0x72, 1);
+    LcdRenderPool pool({&immediate_bus, &retained_bus}, 1);
+    LcdPanel *panels[] = {&immediate, &retained};
+    auto frame = [&] {
+        pool.render(panels, 2);
+        immediate_bus.wait_empty();
+        retained_bus.wait_empty();
+    };
+
+    immediate.frame.assume_blank();
+    retained.frame.assume_blank();
+    {
+        std::lock_guard<std::mutex> guard(retained.lock);
+        draw_static(retained.frame);
+        draw_ticks(retained.frame, 0);
+        draw_state(retained.frame, 0);
+    }
+
+    size_t immediate_bytes = 0, retained_bytes = 0;
+    int errors = 0;
+    for (int tick = 0; tick < frames; tick++) {
+        {
+            LcdFrameGuard lcd = immediate.frame_begin();
+            draw_static(*lcd);
+            draw_ticks(*lcd, tick);
+            draw_state(*lcd, tick);
+        }
+
+        if (tick > 0) {
+            std::lock_guard<std::mutex> guard(retained.lock);
+            draw_ticks(retained.frame, tick);
+            if (tick % 25 == 0) draw_state(retained.frame, tick);
+        }
+
+        size_t i0 = immediate_lcd.bytes, r0 = retained_lcd.bytes;
+        frame();
+        if (tick > 0) {
+            immediate_bytes += immediate_lcd.bytes - i0;
+            retained_bytes += retained_lcd.bytes - r0;
+        }
+        for (uint8_t row = 0; row < 4; row++) errors += immediate_lcd.row(row) != retained_lcd.row(row);
+    }
+
+    printf("%10s %13s\n", "ui", "bytes/frame");
+    printf("%10s %13.1f\n", "immediate", (double)immediate_bytes / (frames - 1));
+    printf("%10s %13.1f\n", "retained", (double)retained_bytes / (frames - 1));
+    printf("%d mismatched rows\n", errors);
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file bench_page_flip.cpp
+ * @brief Host benchmark: screen switches on a 2-line display, redraw vs. DDRAM page flip.
+ *
+ * Build and run on Linux from the repository root:
+ *
+ *     g++ -O2 -std=c++20 -pthread -Imain -Itools tools/bench_page_flip.cpp main/lcd_*.cpp -o bench_page_flip
+ *     ./bench_page_flip
+ *
+ * Two 20x2 panels switch between the same pair of full screens, one by redrawing and
+ * one with LcdPanel::enable_pages(). Both drive an LcdEmulator, which also checks that
+ * the visible DDRAM columns show the expected page after every switch. Only the bytes
+ * sent between the switch request and the new page being visible are counted; the
+ * page-flip panel preloads its back page in the idle frames before that.
+ */
+#include <stdio.h>
+#include <string>
+
+#include "lcd_emulator.h"
+#include "lcd_render_pool.h"
+
+static const char *const screens[2][2] = {
+    {"Temp   21.5 C  OK   ", "Humidity  48 %      "},
+    {"Network  connected  ", "IP 192.168.1.23     "},
+};
+
+static void draw(LcdFrame &frame, int screen)
+{
+    for (uint8_t row = 0; row < 2; row++) frame.put(0, row, screens[screen][row]);
+}
+
+static bool shows(const LcdEmulator &lcd, int screen)
+{
+    return lcd.row(0) == screens[screen][0] && lcd.row(1) == screens[screen][1];
+}
+
+int main()
+{
+    const int switches = 100;
+    LcdEmulator redraw_lcd(20, 2), flip_lcd(20, 2);
+    LcdTxQueue redraw_bus(redraw_lcd), flip_bus(flip_lcd);
+    redraw_bus.start();
+    flip_bus.start();
+    LcdPanel redraw(0x72, 0, 20, 2), flip(0x72, 1, 20, 2);
+    if (flip.enable_pages() != ESP_OK) {
+        printf("page flipping not supported\n");
+        return 1;
+    }
+    LcdRenderPool pool({&redraw_bus, &flip_bus}, 1);
+    LcdPanel *panels[] = {&redraw, &flip};
+    auto frame = [&] {
+        pool.render(panels, 2);
+        redraw_bus.wait_empty();
+        flip_bus.wait_empty();
+    };
+
+    redraw.frame.assume_blank();
+    flip.frame.assume_blank();
+    flip.back()->assume_blank();
+    draw(redraw.frame, 0);
+    draw(flip.frame, 0);
+    frame();
+
+    size_t redraw_bytes = 0, flip_bytes = 0;
+    int errors = 0;
+    for (int i = 1; i <= switches; i++) {
+        int next = i % 2;
+        {
+            // idle time before the switch: the flip panel preloads its back page
+            std::lock_guard<std::mutex> guard(flip.lock);
+            draw(*flip.back(), next);
+        }
+        while (!flip.back_preloaded()) frame();
+
+        size_t r0 = redraw_lcd.bytes, f0 = flip_lcd.bytes;
+        {
+            std::lock_guard<std::mutex> guard(redraw.lock);
+            draw(redraw.frame, next);
+        }
+        {
+            std::lock_guard<std::mutex> guard(flip.lock);
+            flip.flip();
+        }
+        frame();
+        redraw_bytes += redraw_lcd.bytes - r0;
+        flip_bytes += flip_lcd.bytes - f0;
+        errors += !shows(redraw_lcd, next) + !shows(flip_lcd, next);
+    }
+
+    printf("%8s %14s\n", "method", "bytes/switch");
+    printf("%8s %14.1f\n", "redraw", (double)redraw_bytes / switches);
+    printf("%8s %14.1f\n", "flip", (double)flip_bytes / switches);
+    printf("%d wrong screens\n", errors);
+    return errors ? 1 : 0;
+}
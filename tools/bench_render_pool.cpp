@@ -0,0 +1,79 @@
+/**
+ * @file bench_render_pool.cpp
+ * @brief Host benchmark for LcdRenderPool scaling on a wall of panels.
+ *
+ * Build and run on Linux from the repository root:
+ *
+ *     g++ -O2 -std=c++20 -pthread -Imain tools/bench_render_pool.cpp main/lcd_*.cpp -o bench_render_pool
+ *     ./bench_render_pool [panels] [frames]
+ *
+ * Every frame rewrites a random part of each 20x4 panel, then the pool diffs and encodes
+ * all panels and the transmit queues drain into a byte-counting transport.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "lcd_render_pool.h"
+
+#define BENCH_PORTS 2
+
+static void scribble(LcdPanel &panel, std::mt19937 &rng)
+{
+    std::lock_guard<std::mutex> guard(panel.lock);
+    for (int i = 0; i < 6; i++) {
+        char text[12];
+        snprintf(text, sizeof(text), "%08x", (unsigned)rng());
+        panel.frame.put(rng() % panel.frame.cols(), rng() % panel.frame.rows(), text);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t npanels = argc > 1 ? strtoul(argv[1], nullptr, 0) : 16;
+    size_t frames = argc > 2 ? strtoul(argv[2], nullptr, 0) : 2000;
+    unsigned cores = std::thread::hardware_concurrency();
+
+    printf("panels=%zu frames=%zu cores=%u\n", npanels, frames, cores);
+    printf("%8s %12s %12s %10s %12s\n", "workers", "us/frame", "bytes/frame", "steals", "speedup");
+
+    double base = 0;
+    for (size_t workers = 1; workers <= (cores > 1 ? cores : 2); workers *= 2) {
+        LcdNullTransport transport[BENCH_PORTS];
+        std::vector<std::unique_ptr<LcdTxQueue>> queues;
+        std::vector<LcdTxQueue *> ports;
+        for (size_t p = 0; p < BENCH_PORTS; p++) {
+            queues.emplace_back(new LcdTxQueue(transport[p]));
+            ports.push_back(queues.back().get());
+            queues.back()->start();
+        }
+
+        std::vector<std::unique_ptr<LcdPanel>> panels;
+        std::vector<LcdPanel *> list;
+        for (size_t i = 0; i < npanels; i++) {
+            panels.emplace_back(new LcdPanel(0x72, (uint8_t)(i % BENCH_PORTS)));
+            list.push_back(panels.back().get());
+        }
+
+        LcdRenderPool pool(ports, workers);
+        std::mt19937 rng(1234);
+        int64_t busy = 0;
+        for (size_t f = 0; f < frames; f++) {
+            for (auto &panel : panels) scribble(*panel, rng);
+            int64_t start = lcd_now_us();
+            pool.render(list.data(), list.size());
+            busy += lcd_now_us() - start;
+            for (auto &queue : queues) queue->wait_empty();
+        }
+
+        size_t bytes = 0;
+        for (auto &t : transport) bytes += t.bytes;
+        double per_frame = (double)busy / frames;
+        if (base == 0) base = per_frame;
+        printf("%8zu %12.1f %12.1f %10zu %11.2fx\n", workers, per_frame, (double)bytes / frames, pool.steals(),
+               base / per_frame);
+    }
+    return 0;
+}
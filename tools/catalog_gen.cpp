@@ -0,0 +1,348 @@
+/**
+ * @file catalog_gen.cpp
+ * @brief Host tool: compile a UTF-8 message catalog into display-encoded flash tables.
+ *
+ * Build and run on Linux from the repository root:
+ *
+ *     g++ -O2 -std=c++20 -Imain tools/catalog_gen.cpp -o catalog_gen
+ *     ./catalog_gen messages.txt > main/lcd_catalog_messages.h
+ *
+ * The catalog lists the languages, glyphs for characters the display ROM lacks, and
+ * one line per message and language:
+ *
+ *     # the first language stands in for missing translations
+ *     languages en de fr
+ *     # CGRAM slots the catalog may use, default 0 7
+ *     slots 4 7
+ *     glyph Ä .#.#. ..... .###. #...# ##### #...# #...# .....
+ *     glyph é ...#. ..#.. .###. #...# ##### #.... .###. .....
+ *     en ALARM_HIGH "Temperature high"
+ *     de ALARM_HIGH "Temperatur zu hoch"
+ *     fr ALARM_HIGH "Température élevée"
+ *
+ * Characters map to the HD44780 A00 ROM where it has them: ASCII except '\' and '~',
+ * and ¥ ° ä ö ü ñ µ α β (for ß too) ε σ ρ θ π Σ Ω √ ∞ ÷ ¢ → ← █. Anything else needs a
+ * glyph line. Each language assigns the glyphs it uses to the allowed slots in order
+ * of first use; more than fit is an error, as is a character with neither.
+ *
+ * The output header holds message and language ids, every glyph, and per language the
+ * message cells back to back with an offset table and the CGRAM slots each message
+ * needs, for LcdCatalog.
+ */
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "lcd_device_state.h"
+#include "lcd_frame.h"
+
+struct RomChar {
+    uint32_t code_point;
+    uint8_t code;
+};
+
+static const RomChar rom[] = {
+    {0x00A5, 0x5C}, {0x2192, 0x7E}, {0x2190, 0x7F}, {0x00B0, 0xDF}, {0x03B1, 0xE0}, {0x00E4, 0xE1},
+    {0x03B2, 0xE2}, {0x00DF, 0xE2}, {0x03B5, 0xE3}, {0x00B5, 0xE4}, {0x03BC, 0xE4}, {0x03C3, 0xE5},
+    {0x03C1, 0xE6}, {0x221A, 0xE8}, {0x00A2, 0xEC}, {0x00F1, 0xEE}, {0x00F6, 0xEF}, {0x03B8, 0xF2},
+    {0x221E, 0xF3}, {0x03A9, 0xF4}, {0x00FC, 0xF5}, {0x03A3, 0xF6}, {0x03C0, 0xF7}, {0x00F7, 0xFD},
+    {0x2588, 0xFF},
+};
+
+struct Glyph {
+    uint32_t code_point;
+    LcdGlyph glyph;
+};
+
+struct Language {
+    std::string name;
+    std::vector<std::string> texts; // per message, UTF-8; empty: missing
+    std::vector<bool> present;
+    std::vector<int> slot_glyph;    // glyph index per CGRAM slot, -1 if unused
+};
+
+static std::vector<Language> languages;
+static std::vector<std::string> messages;
+static std::vector<Glyph> glyphs;
+static int first_slot = 0, last_slot = LCD_CGRAM_SLOTS - 1;
+
+static bool utf8(const std::string &text, size_t &i, uint32_t &cp)
+{
+    uint8_t c = (uint8_t)text[i++];
+    int extra = c < 0x80 ? 0 : (c & 0xE0) == 0xC0 ? 1 : (c & 0xF0) == 0xE0 ? 2 : (c & 0xF8) == 0xF0 ? 3 : -1;
+    if (extra < 0) return false;
+    cp = extra ? c & (0x3F >> extra) : c;
+    for (int k = 0; k < extra; k++) {
+        if (i >= text.size() || ((uint8_t)text[i] & 0xC0) != 0x80) return false;
+        cp = cp << 6 | ((uint8_t)text[i++] & 0x3F);
+    }
+    return true;
+}
+
+static int find_glyph(uint32_t cp)
+{
+    for (size_t g = 0; g < glyphs.size(); g++) {
+        if (glyphs[g].code_point == cp) return (int)g;
+    }
+    return -1;
+}
+
+/**
+ * @brief Display codes of @p text in @p lang, assigning glyph slots as they come up.
+ */
+static bool encode(Language &lang, const std::string &text, std::vector<uint8_t> &cells, uint8_t &needs,
+                   const std::string &id)
+{
+    cells.clear();
+    needs = 0;
+    for (size_t i = 0; i < text.size();) {
+        uint32_t cp;
+        if (!utf8(text, i, cp)) {
+            fprintf(stderr, "%s %s: invalid UTF-8\n", lang.name.c_str(), id.c_str());
+            return false;
+        }
+        if (cp == LCD_CMD_SETTING) {
+            fprintf(stderr, "%s %s: '|' is the SerLCD command prefix and cannot be shown\n", lang.name.c_str(), id.c_str());
+            return false;
+        }
+        if (cp >= 0x20 && cp < 0x7E && cp != '\\') {
+            cells.push_back((uint8_t)cp);
+            continue;
+        }
+        int code = -1;
+        for (const RomChar &r : rom) {
+            if (r.code_point == cp) code = r.code;
+        }
+        int glyph = find_glyph(cp);
+        if (code < 0 && glyph >= 0) {
+            for (int s = first_slot; s <= last_slot; s++) {
+                if (lang.slot_glyph[s] == glyph) code = s;
+            }
+            for (int s = first_slot; s <= last_slot && code < 0; s++) {
+                if (lang.slot_glyph[s] < 0) {
+                    lang.slot_glyph[s] = glyph;
+                    code = s;
+                }
+            }
+            if (code < 0) {
+                fprintf(stderr, "%s %s: U+%04X needs a CGRAM slot, all %d of the language are taken\n",
+                        lang.name.c_str(), id.c_str(), (unsigned)cp, last_slot - first_slot + 1);
+                return false;
+            }
+            needs |= (uint8_t)(1 << code);
+        }
+        if (code < 0) {
+            fprintf(stderr, "%s %s: U+%04X is not in the display ROM; add a glyph line\n", lang.name.c_str(),
+                    id.c_str(), (unsigned)cp);
+            return false;
+        }
+        cells.push_back((uint8_t)code);
+    }
+    if (cells.size() > 0xFF) {
+        fprintf(stderr, "%s %s: longer than 255 cells\n", lang.name.c_str(), id.c_str());
+        return false;
+    }
+    return true;
+}
+
+static std::vector<std::string> words(const char *line)
+{
+    std::vector<std::string> out;
+    while (*line) {
+        if (isspace((unsigned char)*line)) {
+            line++;
+        } else if (*line == '#' && out.empty()) {
+            break; // comment lines only: glyph rows use '#'
+        } else if (*line == '"') {
+            const char *end = strrchr(line, '"'); // quotes inside the text are kept
+            out.push_back("\"" + std::string(line + 1, end > line ? end : line + strlen(line)));
+            line = end > line ? end + 1 : line + strlen(line);
+        } else {
+            const char *start = line;
+            while (*line && !isspace((unsigned char)*line)) line++;
+            out.push_back(std::string(start, line));
+        }
+    }
+    return out;
+}
+
+static bool parse(FILE *in)
+{
+    char line[1024];
+    int lineno = 0;
+    while (fgets(line, sizeof(line), in)) {
+        lineno++;
+        std::vector<std::string> w = words(line);
+        if (w.empty()) continue;
+        if (w[0] == "languages" && w.size() >= 2 && languages.empty()) {
+            for (size_t i = 1; i < w.size(); i++) languages.push_back({w[i], {}, {}, std::vector<int>(LCD_CGRAM_SLOTS, -1)});
+        } else if (w[0] == "slots" && w.size() == 3) {
+            first_slot = atoi(w[1].c_str());
+            last_slot = atoi(w[2].c_str());
+            if (first_slot < 0 || last_slot >= LCD_CGRAM_SLOTS || first_slot > last_slot) {
+                fprintf(stderr, "line %d: slots are 0 to %d\n", lineno, LCD_CGRAM_SLOTS - 1);
+                return false;
+            }
+        } else if (w[0] == "glyph" && w.size() == 2 + LCD_GLYPH_ROWS) {
+            Glyph g = {};
+            size_t i = 0;
+            if (!utf8(w[1], i, g.code_point) || i != w[1].size() || find_glyph(g.code_point) >= 0) {
+                fprintf(stderr, "line %d: a glyph is for one character, once\n", lineno);
+                return false;
+            }
+            for (int r = 0; r < LCD_GLYPH_ROWS; r++) {
+                const std::string &bits = w[2 + r];
+                if (bits.size() != 5 || bits.find_first_not_of("#.") != std::string::npos) {
+                    fprintf(stderr, "line %d: glyph rows are 5 of '#' and '.'\n", lineno);
+                    return false;
+                }
+                for (int b = 0; b < 5; b++) g.glyph.rows[r] |= (uint8_t)((bits[b] == '#') << (4 - b));
+            }
+            glyphs.push_back(g);
+        } else if (w.size() == 3 && w[2][0] == '"' && !languages.empty()) {
+            Language *lang = nullptr;
+            for (Language &l : languages) {
+                if (l.name == w[0]) lang = &l;
+            }
+            if (!lang || w[1].find_first_not_of("ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_") != std::string::npos) {
+                fprintf(stderr, "line %d: expected 'language MESSAGE_ID \"text\"' for a listed language\n", lineno);
+                return false;
+            }
+            size_t id = 0;
+            while (id < messages.size() && messages[id] != w[1]) id++;
+            if (id == messages.size()) {
+                messages.push_back(w[1]);
+                for (Language &l : languages) {
+                    l.texts.emplace_back();
+                    l.present.push_back(false);
+                }
+            }
+            if (lang->present[id]) {
+                fprintf(stderr, "line %d: %s %s given twice\n", lineno, lang->name.c_str(), w[1].c_str());
+                return false;
+            }
+            lang->texts[id] = w[2].substr(1);
+            lang->present[id] = true;
+        } else {
+            fprintf(stderr, "line %d: cannot parse\n", lineno);
+            return false;
+        }
+    }
+    return !languages.empty();
+}
+
+static std::string lower(const std::string &s)
+{
+    std::string out;
+    for (char c : s) out += (char)tolower((unsigned char)c);
+    return out;
+}
+
+static std::string upper(const std::string &s)
+{
+    std::string out;
+    for (char c : s) out += isalnum((unsigned char)c) ? (char)toupper((unsigned char)c) : '_';
+    return out;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s messages.txt > lcd_catalog_messages.h\n", argv[0]);
+        return 2;
+    }
+    FILE *in = fopen(argv[1], "r");
+    if (!in) {
+        perror(argv[1]);
+        return 1;
+    }
+    bool ok = parse(in);
+    fclose(in);
+    if (!ok) return 1;
+
+    // encode everything before printing anything, so errors leave no half header
+    std::vector<std::vector<std::vector<uint8_t>>> cells(languages.size());
+    std::vector<std::vector<uint8_t>> needs(languages.size());
+    for (size_t l = 0; l < languages.size(); l++) {
+        Language &lang = languages[l];
+        size_t total = 0;
+        for (size_t m = 0; m < messages.size(); m++) {
+            const Language &source = lang.present[m] ? lang : languages[0];
+            if (!lang.present[m]) {
+                fprintf(stderr, "%s %s: missing, using %s\n", lang.name.c_str(), messages[m].c_str(),
+                        source.name.c_str());
+            }
+            cells[l].emplace_back();
+            needs[l].push_back(0);
+            if (!encode(lang, source.texts[m], cells[l].back(), needs[l].back(), messages[m])) return 1;
+            total += cells[l].back().size();
+        }
+        if (total > 0xFFFF) {
+            fprintf(stderr, "%s: more than 64 KiB of text\n", lang.name.c_str());
+            return 1;
+        }
+    }
+
+    printf("/**\n * @file lcd_catalog_messages.h\n * @brief Message catalog generated by tools/catalog_gen from %s. Do not edit.\n */\n",
+           argv[1]);
+    printf("#pragma once\n\n#include <stdint.h>\n\n#include \"lcd_catalog.h\"\n\n");
+    printf("enum LcdMessageId : uint16_t {\n");
+    for (const std::string &m : messages) printf("    LCD_MSG_%s,\n", m.c_str());
+    printf("    LCD_MSG_COUNT\n};\n\n");
+    printf("enum LcdLanguageId : uint8_t {\n");
+    for (const Language &l : languages) printf("    LCD_LANG_%s,\n", upper(l.name).c_str());
+    printf("    LCD_LANG_COUNT\n};\n\n");
+
+    printf("static constexpr LcdGlyph lcd_catalog_glyphs[%zu] = {\n", glyphs.empty() ? 1 : glyphs.size());
+    for (const Glyph &g : glyphs) {
+        printf("    {{");
+        for (int r = 0; r < LCD_GLYPH_ROWS; r++) printf("0x%02X%s", g.glyph.rows[r], r + 1 < LCD_GLYPH_ROWS ? ", " : "");
+        printf("}}, /*!< U+%04X */\n", (unsigned)g.code_point);
+    }
+    if (glyphs.empty()) printf("    {},\n");
+    printf("};\n\n");
+
+    for (size_t l = 0; l < languages.size(); l++) {
+        std::string name = lower(upper(languages[l].name));
+        printf("static constexpr uint16_t lcd_catalog_%s_offsets[LCD_MSG_COUNT + 1] = {", name.c_str());
+        size_t offset = 0;
+        for (size_t m = 0; m <= messages.size(); m++) {
+            printf("%s%zu", m ? ", " : "", offset);
+            if (m < messages.size()) offset += cells[l][m].size();
+        }
+        printf("};\n");
+        printf("static constexpr uint8_t lcd_catalog_%s_cells[%zu] = {\n", name.c_str(), offset ? offset : 1);
+        for (size_t m = 0; m < messages.size(); m++) {
+            printf("    ");
+            for (uint8_t c : cells[l][m]) printf("0x%02X, ", c);
+            printf("/* %s */\n", messages[m].c_str());
+        }
+        printf("};\n");
+        printf("static constexpr uint8_t lcd_catalog_%s_needs[LCD_MSG_COUNT + 1] = {", name.c_str());
+        for (size_t m = 0; m < messages.size(); m++) printf("0x%02X, ", needs[l][m]);
+        printf("0};\n\n");
+    }
+
+    printf("static constexpr LcdCatalogTable lcd_catalog_tables[LCD_LANG_COUNT] = {\n");
+    for (const Language &l : languages) {
+        std::string name = lower(upper(l.name));
+        printf("    {\"%s\", LCD_MSG_COUNT, lcd_catalog_%s_offsets, lcd_catalog_%s_cells, lcd_catalog_%s_needs, {",
+               l.name.c_str(), name.c_str(), name.c_str(), name.c_str());
+        for (int s = 0; s < LCD_CGRAM_SLOTS; s++) {
+            if (l.slot_glyph[s] < 0) {
+                printf("LCD_GLYPH_NONE");
+            } else {
+                printf("%d", l.slot_glyph[s]);
+            }
+            printf(s + 1 < LCD_CGRAM_SLOTS ? ", " : "");
+        }
+        printf("}},\n");
+    }
+    printf("};\n");
+    fprintf(stderr, "%zu messages, %zu languages, %zu glyphs\n", messages.size(), languages.size(), glyphs.size());
+    return 0;
+}
@@ -0,0 +1,327 @@
+/**
+ * @file glyph_slots.cpp
+ * @brief Host tool: assign custom glyphs to fixed CGRAM slots across a set of screens.
+ *
+ * Build and run on Linux from the repository root:
+ *
+ *     g++ -O2 -std=c++20 tools/glyph_slots.cpp -o glyph_slots
+ *     ./glyph_slots screens.txt > main/lcd_glyph_slots.h
+ *
+ * The input lists the glyphs each page uses and, optionally, how often the UI switches
+ * from one page to another:
+ *
+ *     # name  glyphs...
+ *     page home    bell wifi batt_full batt_low
+ *     page menu    arrow check bell
+ *     page graph   bar1 bar2 bar3 bar4 bar5 wifi
+ *     # from  to  weight
+ *     switch home  menu  20
+ *     switch menu  home  20
+ *     switch home  graph 5
+ *
+ * Without switch lines every ordered pair of pages is weighted 1.
+ *
+ * Every glyph gets one slot for the whole UI, so a glyph shared by two pages stays put
+ * and LcdSettings::load_glyph_page() skips it. A switch from page A to page B costs one
+ * upload for each glyph of B whose slot A used for another glyph. Slots that A left
+ * alone are assumed to still hold what B wants. The tool minimizes the weighted sum of
+ * that cost: a greedy start, then single-glyph moves and pairwise swaps until nothing
+ * improves, from a number of shuffled starts.
+ *
+ * The output header has glyph and page ids, the slot of each glyph (the character code
+ * to write) and, per page, the glyph id of each slot for load_glyph_page(). The bitmaps
+ * stay with the application: a constexpr LcdGlyph array in LcdGlyphId order, usually
+ * written with lcd_glyph() from lcd_glyph.h.
+ */
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#define SLOTS 8
+#define RESTARTS 64
+
+struct Switch {
+    int from;
+    int to;
+    double weight;
+};
+
+// LCD_GLYPH_<name> of these is the generated enum's own count or a macro of the engine headers
+static const char *const reserved[] = {"COUNT", "NONE", "ROWS", "COLS", "CMD_BYTES", "SETTLE_MS"};
+
+static std::vector<std::string> glyph_names;
+static std::vector<std::string> page_names;
+static std::vector<std::vector<int>> pages;   // glyph ids per page
+static std::vector<std::vector<int>> used_by; // page ids per glyph
+static std::vector<Switch> switches;
+
+static int find(const std::vector<std::string> &names, const std::string &name)
+{
+    for (size_t i = 0; i < names.size(); i++) {
+        if (names[i] == name) return (int)i;
+    }
+    return -1;
+}
+
+static int intern(std::vector<std::string> &names, const std::string &name)
+{
+    int id = find(names, name);
+    if (id >= 0) return id;
+    names.push_back(name);
+    return (int)names.size() - 1;
+}
+
+static std::string identifier(const std::string &name)
+{
+    std::string out;
+    for (char c : name) out += isalnum((unsigned char)c) ? (char)toupper((unsigned char)c) : '_';
+    return out;
+}
+
+static bool parse(FILE *in)
+{
+    char line[1024];
+    int lineno = 0;
+    while (fgets(line, sizeof(line), in)) {
+        lineno++;
+        char *hash = strchr(line, '#');
+        if (hash) *hash = 0;
+        std::vector<std::string> words;
+        for (char *word = strtok(line, " \t\r\n"); word; word = strtok(nullptr, " \t\r\n")) words.push_back(word);
+        if (words.empty()) continue;
+
+        if (words[0] == "page" && words.size() >= 2) {
+            if (find(page_names, words[1]) >= 0) {
+                fprintf(stderr, "line %d: page %s defined twice\n", lineno, words[1].c_str());
+                return false;
+            }
+            page_names.push_back(words[1]);
+            pages.emplace_back();
+            for (size_t i = 2; i < words.size(); i++) {
+                std::string id = identifier(words[i]);
+                if (std::find(std::begin(reserved), std::end(reserved), id) != std::end(reserved)) {
+                    fprintf(stderr, "line %d: glyph name %s is reserved\n", lineno, words[i].c_str());
+                    return false;
+                }
+                int glyph = intern(glyph_names, words[i]);
+                if (std::find(pages.back().begin(), pages.back().end(), glyph) == pages.back().end()) {
+                    pages.back().push_back(glyph);
+                }
+            }
+            if (pages.back().size() > SLOTS) {
+                fprintf(stderr, "line %d: page %s uses %zu glyphs, CGRAM has %d slots\n", lineno,
+                        words[1].c_str(), pages.back().size(), SLOTS);
+                return false;
+            }
+        } else if (words[0] == "switch" && words.size() == 4) {
+            Switch s = {find(page_names, words[1]), find(page_names, words[2]), atof(words[3].c_str())};
+            if (s.from < 0 || s.to < 0) {
+                fprintf(stderr, "line %d: switch names an undefined page\n", lineno);
+                return false;
+            }
+            switches.push_back(s);
+        } else {
+            fprintf(stderr, "line %d: expected 'page name glyphs...' or 'switch from to weight'\n", lineno);
+            return false;
+        }
+    }
+    if (glyph_names.size() >= 0xFF) {
+        fprintf(stderr, "too many glyphs\n");
+        return false;
+    }
+    if (switches.empty()) {
+        for (size_t a = 0; a < pages.size(); a++) {
+            for (size_t b = 0; b < pages.size(); b++) {
+                if (a != b) switches.push_back({(int)a, (int)b, 1.0});
+            }
+        }
+    }
+    used_by.assign(glyph_names.size(), {});
+    for (size_t p = 0; p < pages.size(); p++) {
+        for (int glyph : pages[p]) used_by[glyph].push_back((int)p);
+    }
+    return true;
+}
+
+static double cost(const std::vector<int> &slot)
+{
+    double total = 0;
+    for (const Switch &s : switches) {
+        int held[SLOTS];
+        std::fill(held, held + SLOTS, -1);
+        for (int glyph : pages[s.from]) {
+            if (slot[glyph] >= 0) held[slot[glyph]] = glyph; // -1: not placed yet
+        }
+        int uploads = 0;
+        for (int glyph : pages[s.to]) {
+            if (slot[glyph] >= 0 && held[slot[glyph]] >= 0 && held[slot[glyph]] != glyph) uploads++;
+        }
+        total += s.weight * uploads;
+    }
+    return total;
+}
+
+/**
+ * @brief Can @p glyph use @p s without clashing with another glyph of one of its pages?
+ */
+static bool fits(const std::vector<int> &slot, int glyph, int s, int ignore = -1)
+{
+    for (int page : used_by[glyph]) {
+        for (int other : pages[page]) {
+            if (other != glyph && other != ignore && slot[other] == s) return false;
+        }
+    }
+    return true;
+}
+
+static bool greedy(std::vector<int> &slot, std::mt19937 &rng)
+{
+    std::vector<int> order(glyph_names.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = (int)i;
+    std::shuffle(order.begin(), order.end(), rng);
+    // glyphs on many pages are the most constrained; place them first
+    std::stable_sort(order.begin(), order.end(), [](int a, int b) { return used_by[a].size() > used_by[b].size(); });
+
+    slot.assign(glyph_names.size(), -1);
+    for (int glyph : order) {
+        int best = -1;
+        double best_cost = 0;
+        for (int s = 0; s < SLOTS; s++) {
+            if (!fits(slot, glyph, s)) continue;
+            slot[glyph] = s;
+            double c = cost(slot);
+            if (best < 0 || c < best_cost) {
+                best = s;
+                best_cost = c;
+            }
+        }
+        if (best < 0) return false;
+        slot[glyph] = best;
+    }
+    return true;
+}
+
+static double improve(std::vector<int> &slot)
+{
+    double current = cost(slot);
+    bool improved = true;
+    while (improved) {
+        improved = false;
+        for (size_t g = 0; g < slot.size(); g++) {
+            int old = slot[g];
+            for (int s = 0; s < SLOTS; s++) {
+                if (s == old || !fits(slot, (int)g, s)) continue;
+                slot[g] = s;
+                double c = cost(slot);
+                if (c < current - 1e-9) {
+                    current = c;
+                    old = s;
+                    improved = true;
+                } else {
+                    slot[g] = old;
+                }
+            }
+        }
+        for (size_t a = 0; a < slot.size(); a++) {
+            for (size_t b = a + 1; b < slot.size(); b++) {
+                int sa = slot[a], sb = slot[b];
+                if (sa == sb || !fits(slot, (int)a, sb, (int)b) || !fits(slot, (int)b, sa, (int)a)) continue;
+                std::swap(slot[a], slot[b]);
+                double c = cost(slot);
+                if (c < current - 1e-9) {
+                    current = c;
+                    improved = true;
+                } else {
+                    std::swap(slot[a], slot[b]);
+                }
+            }
+        }
+    }
+    return current;
+}
+
+static void emit(const std::vector<int> &slot, double best, const char *input)
+{
+    double weight = 0;
+    for (const Switch &s : switches) weight += s.weight;
+
+    printf("/**\n * @file lcd_glyph_slots.h\n * @brief CGRAM slot table generated by tools/glyph_slots from %s. Do not edit.\n", input);
+    printf(" *\n * Expected uploads per page switch: %.3f\n */\n", weight > 0 ? best / weight : 0.0);
+    printf("#pragma once\n\n#include <stdint.h>\n\n#include \"lcd_device_state.h\"\n\n");
+
+    printf("enum LcdGlyphId : uint8_t {\n");
+    for (size_t g = 0; g < glyph_names.size(); g++) printf("    LCD_GLYPH_%s,\n", identifier(glyph_names[g]).c_str());
+    printf("    LCD_GLYPH_COUNT\n};\n\n");
+
+    printf("enum LcdPageId : uint8_t {\n");
+    for (size_t p = 0; p < page_names.size(); p++) printf("    LCD_PAGE_%s,\n", identifier(page_names[p]).c_str());
+    printf("    LCD_PAGE_COUNT\n};\n\n");
+
+    printf("/** @brief CGRAM slot, and so the character code, of each glyph */\n");
+    printf("static constexpr uint8_t lcd_glyph_slot[LCD_GLYPH_COUNT] = {\n");
+    for (size_t g = 0; g < glyph_names.size(); g++) {
+        printf("    %d, /*!< %s */\n", slot[g], glyph_names[g].c_str());
+    }
+    printf("};\n\n");
+
+    printf("/** @brief Glyph id per slot for each page, for LcdSettings::load_glyph_page() */\n");
+    printf("static constexpr uint8_t lcd_page_glyphs[LCD_PAGE_COUNT][LCD_CGRAM_SLOTS] = {\n");
+    for (size_t p = 0; p < pages.size(); p++) {
+        printf("    {");
+        for (int s = 0; s < SLOTS; s++) {
+            const char *name = nullptr;
+            for (int glyph : pages[p]) {
+                if (slot[glyph] == s) name = glyph_names[glyph].c_str();
+            }
+            if (name) {
+                printf("LCD_GLYPH_%s", identifier(name).c_str());
+            } else {
+                printf("LCD_GLYPH_NONE");
+            }
+            printf(s + 1 < SLOTS ? ", " : "");
+        }
+        printf("}, /*!< %s */\n", page_names[p].c_str());
+    }
+    printf("};\n");
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s screens.txt > lcd_glyph_slots.h\n", argv[0]);
+        return 2;
+    }
+    FILE *in = fopen(argv[1], "r");
+    if (!in) {
+        perror(argv[1]);
+        return 1;
+    }
+    bool ok = parse(in);
+    fclose(in);
+    if (!ok) return 1;
+
+    std::mt19937 rng(1); // reproducible output for the same input
+    std::vector<int> best;
+    double best_cost = 0;
+    for (int restart = 0; restart < RESTARTS; restart++) {
+        std::vector<int> slot;
+        if (!greedy(slot, rng)) continue;
+        double c = improve(slot);
+        if (best.empty() || c < best_cost) {
+            best = slot;
+            best_cost = c;
+        }
+    }
+    if (best.empty() && !glyph_names.empty()) {
+        fprintf(stderr, "no assignment found: pages share glyphs in a way 8 slots cannot hold\n");
+        return 1;
+    }
+    fprintf(stderr, "%zu glyphs, %zu pages, weighted uploads %.3f\n", glyph_names.size(), pages.size(), best_cost);
+    emit(best, best_cost, argv[1]);
+    return 0;
+}
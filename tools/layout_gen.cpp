@@ -0,0 +1,605 @@
+/**
+ * @file layout_gen.cpp
+ * @brief Host tool: build a screen layout image for LcdLayout and check it on the emulator.
+ *
+ * Build and run on Linux from the repository root:
+ *
+ *     g++ -O2 -std=c++20 -pthread -Imain -Itools tools/layout_gen.cpp main/lcd_*.cpp -o layout_gen
+ *     ./layout_gen screens.txt layout.bin
+ *     ./layout_gen --header screens.txt lcd_screens.h
+ *
+ * The input describes the display, the glyphs and the screens:
+ *
+ *     display 20 4
+ *     # bus clock in Hz, share of it field updates may use in percent
+ *     bus 100000 50
+ *     # name   8 rows of 5 pixels
+ *     glyph degree .##.. #..#. #..#. .##.. ..... ..... ..... .....
+ *     screen boiler
+ *     # col row "text", {glyph} for a custom glyph
+ *     text   0 0 "Boiler"
+ *     text  12 1 "{degree}C"
+ *     # name col row width left|right ["printf format" [updates per second]]
+ *     field  temp 7 1 5 right "%5.1f" 2
+ *     # type name col row width height; type is text, progress or clock
+ *     widget progress ota 0 3 20 1
+ *
+ * Lines starting with '#' are comments. Each screen gets CGRAM slots for its glyphs in
+ * order of first use. Text, fields and widgets must stay on the display and must not
+ * overlap. The static text is encoded with the engine's own lcd_encode() for a blank
+ * display. The image is then opened with LcdLayout and every screen is shown, in
+ * order, on an LcdEmulator, whose cells and CGRAM are compared with the description.
+ *
+ * A format takes exactly one conversion. Fields with an update rate are checked
+ * against the bus budget: a field write costs the address byte, the DDRAM address
+ * command and its cells, at nine bits a byte. With --header the verified image is
+ * written as constexpr tables for lcd_screen.h instead, with a typed setter per
+ * field; tools/lcd_screens.cmake runs this as part of the build.
+ */
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "lcd_emulator.h"
+#include "lcd_layout.h"
+#include "lcd_render_pool.h"
+
+struct FieldHint {
+    std::string format; // printf format, empty for plain text
+    unsigned rate_hz;   // expected updates per second, 0 if not given
+};
+
+struct Screen {
+    std::string name;
+    std::vector<uint8_t> cells;
+    std::vector<int> owner;  // line that placed each cell, -1 for none
+    std::vector<int> glyphs; // glyph index per slot
+    std::vector<LcdLayoutField> fields;
+    std::vector<FieldHint> hints; // per field, for --header
+    std::vector<LcdLayoutWidget> widgets;
+};
+
+static uint8_t cols, rows;
+static unsigned bus_hz = 100000, budget_percent = 50;
+static std::vector<std::string> glyph_names;
+static std::vector<LcdGlyph> glyphs;
+static std::vector<Screen> screens;
+
+static std::vector<std::string> words(const char *line)
+{
+    std::vector<std::string> out;
+    while (*line) {
+        if (isspace((unsigned char)*line)) {
+            line++;
+        } else if (*line == '#' && out.empty()) {
+            break; // comment lines only: glyph rows use '#'
+        } else if (*line == '"') {
+            const char *end = strchr(++line, '"');
+            if (!end) end = line + strlen(line);
+            out.push_back("\"" + std::string(line, end)); // leading quote marks a string
+            line = *end ? end + 1 : end;
+        } else {
+            const char *start = line;
+            while (*line && !isspace((unsigned char)*line)) line++;
+            out.push_back(std::string(start, line));
+        }
+    }
+    return out;
+}
+
+static bool place(Screen &s, int lineno, uint8_t col, uint8_t row, uint8_t width, uint8_t height)
+{
+    if (col + width > cols || row + height > rows) {
+        fprintf(stderr, "line %d: off the %dx%d display\n", lineno, cols, rows);
+        return false;
+    }
+    for (uint8_t r = row; r < row + height; r++) {
+        for (uint8_t c = col; c < col + width; c++) {
+            int &owner = s.owner[r * cols + c];
+            if (owner >= 0) {
+                fprintf(stderr, "line %d: overlaps line %d at column %d, row %d\n", lineno, owner, c, r);
+                return false;
+            }
+            owner = lineno;
+        }
+    }
+    return true;
+}
+
+static bool text(Screen &s, int lineno, uint8_t col, uint8_t row, const std::string &str)
+{
+    std::vector<uint8_t> cells;
+    for (size_t i = 0; i < str.size(); i++) {
+        if (str[i] != '{') {
+            cells.push_back(LcdFrame::sanitize((uint8_t)str[i]));
+            continue;
+        }
+        size_t end = str.find('}', i);
+        std::string name = str.substr(i + 1, end == std::string::npos ? end : end - i - 1);
+        int glyph = -1;
+        for (size_t g = 0; g < glyph_names.size(); g++) {
+            if (glyph_names[g] == name) glyph = (int)g;
+        }
+        if (end == std::string::npos || glyph < 0) {
+            fprintf(stderr, "line %d: unknown glyph {%s}\n", lineno, name.c_str());
+            return false;
+        }
+        int slot = -1;
+        for (size_t k = 0; k < s.glyphs.size(); k++) {
+            if (s.glyphs[k] == glyph) slot = (int)k;
+        }
+        if (slot < 0) {
+            if (s.glyphs.size() == LCD_CGRAM_SLOTS) {
+                fprintf(stderr, "line %d: screen %s uses more than %d glyphs\n", lineno, s.name.c_str(), LCD_CGRAM_SLOTS);
+                return false;
+            }
+            slot = (int)s.glyphs.size();
+            s.glyphs.push_back(glyph);
+        }
+        cells.push_back((uint8_t)slot);
+        i = end;
+    }
+    if (cells.empty() || !place(s, lineno, col, row, (uint8_t)cells.size(), 1)) return !cells.empty();
+    memcpy(&s.cells[row * cols + col], cells.data(), cells.size());
+    return true;
+}
+
+static bool name(char *out, size_t size, const std::string &in, int lineno)
+{
+    if (in.size() >= size) {
+        fprintf(stderr, "line %d: name %s is longer than %zu characters\n", lineno, in.c_str(), size - 1);
+        return false;
+    }
+    memset(out, 0, size);
+    memcpy(out, in.data(), in.size());
+    return true;
+}
+
+/**
+ * @brief Argument type of the single conversion in @p format, nullptr if it has none,
+ *        more than one or one with a length modifier.
+ */
+static const char *conversion(const std::string &format)
+{
+    const char *type = nullptr;
+    for (size_t i = 0; i < format.size(); i++) {
+        if (format[i] != '%') continue;
+        i++;
+        if (i < format.size() && format[i] == '%') continue;
+        while (i < format.size() && strchr("-+ #0123456789.", format[i])) i++;
+        if (i == format.size() || type) return nullptr;
+        char c = format[i];
+        type = strchr("dic", c) ? "int" : strchr("uxXo", c) ? "unsigned" : strchr("fFeEgG", c) ? "double"
+             : c == 's' ? "const char *" : nullptr;
+        if (!type) return nullptr;
+    }
+    return type;
+}
+
+static bool parse(FILE *in)
+{
+    char line[1024];
+    int lineno = 0;
+    while (fgets(line, sizeof(line), in)) {
+        lineno++;
+        std::vector<std::string> w = words(line);
+        if (w.empty()) continue;
+        const std::string &kind = w[0];
+        if (kind == "display" && w.size() == 3 && screens.empty()) {
+            cols = (uint8_t)atoi(w[1].c_str());
+            rows = (uint8_t)atoi(w[2].c_str());
+            if (cols == 0 || rows == 0 || cols > 40 || rows > 4) {
+                fprintf(stderr, "line %d: unsupported display size\n", lineno);
+                return false;
+            }
+        } else if (kind == "glyph" && w.size() == 2 + LCD_GLYPH_ROWS) {
+            LcdGlyph glyph = {};
+            for (int r = 0; r < LCD_GLYPH_ROWS; r++) {
+                const std::string &bits = w[2 + r];
+                if (bits.size() != 5 || bits.find_first_not_of("#.") != std::string::npos) {
+                    fprintf(stderr, "line %d: glyph rows are 5 of '#' and '.'\n", lineno);
+                    return false;
+                }
+                for (int b = 0; b < 5; b++) glyph.rows[r] |= (uint8_t)((bits[b] == '#') << (4 - b));
+            }
+            glyph_names.push_back(w[1]);
+            glyphs.push_back(glyph);
+        } else if (kind == "bus" && w.size() == 3) {
+            bus_hz = (unsigned)atoi(w[1].c_str());
+            budget_percent = (unsigned)atoi(w[2].c_str());
+            if (bus_hz == 0 || budget_percent == 0 || budget_percent > 100) {
+                fprintf(stderr, "line %d: expected 'bus hz budget_percent'\n", lineno);
+                return false;
+            }
+        } else if (kind == "screen" && w.size() == 2 && cols) {
+            if (w[1].size() >= sizeof(LcdLayoutScreen::name)) {
+                fprintf(stderr, "line %d: screen name too long\n", lineno);
+                return false;
+            }
+            screens.push_back({w[1], std::vector<uint8_t>((size_t)cols * rows, ' '),
+                               std::vector<int>((size_t)cols * rows, -1), {}, {}, {}, {}});
+        } else if (screens.empty()) {
+            fprintf(stderr, "line %d: expected 'display cols rows', glyphs, then 'screen name'\n", lineno);
+            return false;
+        } else if (kind == "text" && w.size() == 4 && w[3][0] == '"') {
+            if (!text(screens.back(), lineno, (uint8_t)atoi(w[1].c_str()), (uint8_t)atoi(w[2].c_str()), w[3].substr(1))) {
+                return false;
+            }
+        } else if (kind == "field" && w.size() >= 6 && w.size() <= 8 && (w[5] == "left" || w[5] == "right")) {
+            FieldHint hint = {};
+            for (size_t i = 6; i < w.size(); i++) {
+                if (w[i][0] == '"') {
+                    hint.format = w[i].substr(1);
+                    if (!conversion(hint.format)) {
+                        fprintf(stderr, "line %d: a field format has exactly one plain conversion, e.g. %%5.1f\n", lineno);
+                        return false;
+                    }
+                } else {
+                    hint.rate_hz = (unsigned)atoi(w[i].c_str());
+                }
+            }
+            LcdLayoutField f = {};
+            f.col = (uint8_t)atoi(w[2].c_str());
+            f.row = (uint8_t)atoi(w[3].c_str());
+            f.width = (uint8_t)atoi(w[4].c_str());
+            f.align = w[5] == "right" ? LCD_LAYOUT_ALIGN_RIGHT : LCD_LAYOUT_ALIGN_LEFT;
+            if (!name(f.name, sizeof(f.name), w[1], lineno) || !place(screens.back(), lineno, f.col, f.row, f.width, 1)) {
+                return false;
+            }
+            screens.back().fields.push_back(f);
+            screens.back().hints.push_back(hint);
+        } else if (kind == "widget" && w.size() == 7) {
+            LcdLayoutWidget wd = {};
+            wd.type = w[1] == "text" ? LCD_LAYOUT_WIDGET_TEXT : w[1] == "progress" ? LCD_LAYOUT_WIDGET_PROGRESS
+                    : w[1] == "clock" ? LCD_LAYOUT_WIDGET_CLOCK : 0;
+            wd.col = (uint8_t)atoi(w[3].c_str());
+            wd.row = (uint8_t)atoi(w[4].c_str());
+            wd.width = (uint8_t)atoi(w[5].c_str());
+            wd.height = (uint8_t)atoi(w[6].c_str());
+            if (!wd.type) {
+                fprintf(stderr, "line %d: unknown widget type %s\n", lineno, w[1].c_str());
+                return false;
+            }
+            if (!name(wd.name, sizeof(wd.name), w[2], lineno) ||
+                !place(screens.back(), lineno, wd.col, wd.row, wd.width, wd.height)) {
+                return false;
+            }
+            screens.back().widgets.push_back(wd);
+        } else {
+            fprintf(stderr, "line %d: cannot parse\n", lineno);
+            return false;
+        }
+    }
+    if (glyphs.size() >= LCD_GLYPH_NONE) {
+        fprintf(stderr, "too many glyphs\n");
+        return false;
+    }
+    return !screens.empty();
+}
+
+static uint32_t append(std::vector<uint8_t> &image, const void *data, size_t size, size_t align)
+{
+    while (image.size() % align) image.push_back(0);
+    uint32_t offset = (uint32_t)image.size();
+    image.insert(image.end(), (const uint8_t *)data, (const uint8_t *)data + size);
+    return offset;
+}
+
+static std::vector<uint8_t> build(std::vector<size_t> &tx_bytes)
+{
+    std::vector<uint8_t> image(sizeof(LcdLayoutHeader), 0);
+    std::vector<LcdLayoutScreen> table(screens.size());
+    uint32_t table_offset = append(image, table.data(), table.size() * sizeof(LcdLayoutScreen), 4);
+    uint32_t glyph_offset = append(image, glyphs.data(), glyphs.size() * sizeof(LcdGlyph), 1);
+
+    for (size_t i = 0; i < screens.size(); i++) {
+        const Screen &s = screens[i];
+        LcdFrame frame(cols, rows);
+        frame.assume_blank();
+        for (uint8_t row = 0; row < rows; row++) frame.put_cells(0, row, &s.cells[row * cols], cols);
+        std::vector<LcdRun> runs;
+        std::vector<LcdTransaction> txs;
+        if (frame.diff(runs)) lcd_encode(frame, runs, nullptr, 0, txs);
+
+        std::vector<LcdEncodedTx> encoded(txs.size());
+        tx_bytes.push_back(0);
+        for (size_t t = 0; t < txs.size(); t++) {
+            LcdEncodedTx &enc = encoded[t];
+            memset(&enc, 0, sizeof(enc));
+            enc.len = txs[t].len;
+            enc.nruns = txs[t].nruns;
+            enc.settle_ms = txs[t].settle_ms;
+            memcpy(enc.bytes, txs[t].bytes, txs[t].len);
+            memcpy(enc.runs, txs[t].runs, txs[t].nruns * sizeof(LcdRun));
+            tx_bytes.back() += enc.len;
+        }
+
+        LcdLayoutScreen &entry = table[i];
+        memset(&entry, 0, sizeof(entry));
+        memcpy(entry.name, s.name.data(), s.name.size());
+        entry.cells = append(image, s.cells.data(), s.cells.size(), 1);
+        entry.tx = append(image, encoded.data(), encoded.size() * sizeof(LcdEncodedTx), 2);
+        entry.fields = append(image, s.fields.data(), s.fields.size() * sizeof(LcdLayoutField), 1);
+        entry.widgets = append(image, s.widgets.data(), s.widgets.size() * sizeof(LcdLayoutWidget), 1);
+        entry.tx_count = (uint16_t)encoded.size();
+        entry.field_count = (uint8_t)s.fields.size();
+        entry.widget_count = (uint8_t)s.widgets.size();
+        memset(entry.glyphs, LCD_GLYPH_NONE, sizeof(entry.glyphs));
+        for (size_t slot = 0; slot < s.glyphs.size(); slot++) entry.glyphs[slot] = (uint8_t)s.glyphs[slot];
+    }
+    while (image.size() % 4) image.push_back(0);
+    memcpy(&image[table_offset], table.data(), table.size() * sizeof(LcdLayoutScreen));
+
+    LcdLayoutHeader header = {};
+    header.magic = LCD_LAYOUT_MAGIC;
+    header.version = LCD_LAYOUT_VERSION;
+    header.screen_count = (uint16_t)screens.size();
+    header.size = (uint32_t)image.size();
+    header.cols = cols;
+    header.rows = rows;
+    header.glyph_count = (uint8_t)glyphs.size();
+    header.glyphs = glyph_offset;
+    header.screens = table_offset;
+    memcpy(image.data(), &header, sizeof(header));
+    return image;
+}
+
+/**
+ * @brief Show every screen on the emulator through LcdLayout, as the firmware would.
+ */
+static int verify(const std::vector<uint8_t> &image)
+{
+    LcdLayout layout;
+    if (layout.open(image.data(), image.size()) != ESP_OK) {
+        fprintf(stderr, "the image does not open\n");
+        return 1;
+    }
+    LcdEmulator lcd(cols, rows);
+    LcdTxQueue bus(lcd);
+    bus.start();
+    LcdPanel panel(0x72, 0, cols, rows);
+    LcdSettings settings(panel);
+    LcdRenderPool pool({&bus}, 1);
+    LcdPanel *panels[] = {&panel};
+    int errors = 0;
+    for (const Screen &s : screens) {
+        size_t before = lcd.bytes;
+        if (layout.show(panel, settings, layout.screen(s.name.c_str())) != ESP_OK) return 1;
+        pool.render(panels, 1);
+        bus.wait_empty();
+        for (uint8_t row = 0; row < rows; row++) {
+            std::string expected;
+            for (uint8_t col = 0; col < cols; col++) {
+                uint8_t c = s.cells[row * cols + col];
+                expected += c < 8 ? (char)('0' + c) : (char)c;
+            }
+            if (lcd.row(row) != expected) {
+                fprintf(stderr, "screen %s row %d shows |%s|, expected |%s|\n", s.name.c_str(), row,
+                        lcd.row(row).c_str(), expected.c_str());
+                errors++;
+            }
+        }
+        for (size_t slot = 0; slot < s.glyphs.size(); slot++) {
+            if (memcmp(lcd.cgram[slot], glyphs[s.glyphs[slot]].rows, LCD_GLYPH_ROWS) != 0) {
+                fprintf(stderr, "screen %s: CGRAM slot %zu does not hold %s\n", s.name.c_str(), slot,
+                        glyph_names[s.glyphs[slot]].c_str());
+                errors++;
+            }
+        }
+        fprintf(stderr, "  %-15s %4zu bytes to show\n", s.name.c_str(), lcd.bytes - before);
+    }
+    return errors ? 1 : 0;
+}
+
+static bool check_budget()
+{
+    bool ok = true;
+    for (const Screen &s : screens) {
+        double bits = 0;
+        for (size_t f = 0; f < s.fields.size(); f++) {
+            // one write per update: address byte, DDRAM address command, the cells
+            bits += s.hints[f].rate_hz * (1 + 2 + s.fields[f].width) * 9.0;
+        }
+        double percent = 100.0 * bits / bus_hz;
+        fprintf(stderr, "  %-15s fields need %5.1f%% of the bus\n", s.name.c_str(), percent);
+        if (percent > budget_percent) {
+            fprintf(stderr, "screen %s: field updates need %.1f%% of the %u Hz bus, the budget is %u%%\n",
+                    s.name.c_str(), percent, bus_hz, budget_percent);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+static std::string identifier(const std::string &name, bool upper)
+{
+    std::string out;
+    for (char c : name) {
+        out += isalnum((unsigned char)c) ? (char)(upper ? toupper((unsigned char)c) : tolower((unsigned char)c)) : '_';
+    }
+    return out;
+}
+
+static void emit_bytes(FILE *out, const uint8_t *bytes, size_t len)
+{
+    for (size_t i = 0; i < len; i++) fprintf(out, "%s0x%02X", i ? ", " : "", bytes[i]);
+}
+
+/**
+ * @brief Write the constexpr tables for lcd_screen.h, read back from the verified image.
+ */
+static void emit_header(FILE *out, const std::vector<uint8_t> &image, const char *input, const char *path)
+{
+    const char *file = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+    const LcdLayoutHeader *header = (const LcdLayoutHeader *)image.data();
+    const LcdLayoutScreen *table = (const LcdLayoutScreen *)&image[header->screens];
+    const size_t cells = (size_t)cols * rows;
+
+    fprintf(out, "/**\n * @file %s\n * @brief Screens generated by tools/layout_gen from %s. Do not edit.\n", file, input);
+    fprintf(out, " *\n * Field updates were checked against %u%% of a %u Hz bus.\n */\n", budget_percent, bus_hz);
+    fprintf(out, "#pragma once\n\n#include \"lcd_screen.h\"\n\n");
+
+    fprintf(out, "enum LcdScreenId : uint8_t {\n");
+    for (const Screen &s : screens) fprintf(out, "    LCD_SCREEN_%s,\n", identifier(s.name, true).c_str());
+    fprintf(out, "    LCD_SCREEN_COUNT\n};\n\nenum LcdFieldId : uint16_t {\n");
+    for (const Screen &s : screens) {
+        for (const LcdLayoutField &f : s.fields) {
+            fprintf(out, "    LCD_FIELD_%s_%s,\n", identifier(s.name, true).c_str(), identifier(f.name, true).c_str());
+        }
+    }
+    fprintf(out, "    LCD_FIELD_COUNT\n};\n\nenum LcdWidgetId : uint16_t {\n");
+    for (const Screen &s : screens) {
+        for (const LcdLayoutWidget &w : s.widgets) {
+            fprintf(out, "    LCD_WIDGET_%s_%s,\n", identifier(s.name, true).c_str(), identifier(w.name, true).c_str());
+        }
+    }
+    fprintf(out, "    LCD_WIDGET_COUNT\n};\n\n");
+
+    fprintf(out, "static constexpr LcdGlyph lcd_screen_glyphs[%zu] = {\n", glyphs.empty() ? 1 : glyphs.size());
+    for (size_t g = 0; g < glyphs.size(); g++) {
+        fprintf(out, "    {{");
+        emit_bytes(out, glyphs[g].rows, LCD_GLYPH_ROWS);
+        fprintf(out, "}}, /*!< %s */\n", glyph_names[g].c_str());
+    }
+    if (glyphs.empty()) fprintf(out, "    {},\n");
+    fprintf(out, "};\n\n");
+
+    for (size_t i = 0; i < screens.size(); i++) {
+        const LcdLayoutScreen &entry = table[i];
+        std::string name = identifier(screens[i].name, false);
+        fprintf(out, "static constexpr uint8_t lcd_screen_%s_cells[%zu] = {\n", name.c_str(), cells);
+        for (uint8_t row = 0; row < rows; row++) {
+            fprintf(out, "    ");
+            emit_bytes(out, &image[entry.cells + row * cols], cols);
+            fprintf(out, ",\n");
+        }
+        fprintf(out, "};\n");
+        if (entry.tx_count) {
+            const LcdEncodedTx *tx = (const LcdEncodedTx *)&image[entry.tx];
+            fprintf(out, "static constexpr LcdEncodedTx lcd_screen_%s_tx[%u] = {\n", name.c_str(), entry.tx_count);
+            for (uint16_t t = 0; t < entry.tx_count; t++) {
+                fprintf(out, "    {%u, %u, %u, {", tx[t].len, tx[t].nruns, tx[t].settle_ms);
+                emit_bytes(out, tx[t].bytes, tx[t].len);
+                fprintf(out, "}, {");
+                for (uint8_t r = 0; r < tx[t].nruns; r++) {
+                    fprintf(out, "%s{%u, %u, %u}", r ? ", " : "", tx[t].runs[r].row, tx[t].runs[r].col, tx[t].runs[r].len);
+                }
+                fprintf(out, "}},\n");
+            }
+            fprintf(out, "};\n");
+        }
+        fprintf(out, "\n");
+    }
+
+    fprintf(out, "static constexpr LcdScreenSpec lcd_screens[LCD_SCREEN_COUNT] = {\n");
+    for (size_t i = 0; i < screens.size(); i++) {
+        const LcdLayoutScreen &entry = table[i];
+        std::string name = identifier(screens[i].name, false);
+        fprintf(out, "    {\"%s\", lcd_screen_%s_cells, ", screens[i].name.c_str(), name.c_str());
+        if (entry.tx_count) {
+            fprintf(out, "lcd_screen_%s_tx, %u, {", name.c_str(), entry.tx_count);
+        } else {
+            fprintf(out, "nullptr, 0, {");
+        }
+        for (int slot = 0; slot < LCD_CGRAM_SLOTS; slot++) {
+            fprintf(out, "%s%u", slot ? ", " : "", entry.glyphs[slot]);
+        }
+        fprintf(out, "}},\n");
+    }
+    fprintf(out, "};\n\n");
+
+    size_t field_count = 0, widget_count = 0;
+    for (const Screen &s : screens) {
+        field_count += s.fields.size();
+        widget_count += s.widgets.size();
+    }
+    fprintf(out, "static constexpr LcdFieldSpec lcd_fields[%zu] = {\n", field_count ? field_count : 1);
+    for (const Screen &s : screens) {
+        for (size_t f = 0; f < s.fields.size(); f++) {
+            const LcdLayoutField &field = s.fields[f];
+            fprintf(out, "    {%u, %u, %u, %u, %u, ", field.col, field.row, field.width, field.align, s.hints[f].rate_hz);
+            if (s.hints[f].format.empty()) {
+                fprintf(out, "nullptr");
+            } else {
+                fprintf(out, "\"%s\"", s.hints[f].format.c_str());
+            }
+            fprintf(out, "}, /*!< %s %s */\n", s.name.c_str(), field.name);
+        }
+    }
+    if (!field_count) fprintf(out, "    {},\n");
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "static constexpr LcdLayoutWidget lcd_widgets[%zu] = {\n", widget_count ? widget_count : 1);
+    for (const Screen &s : screens) {
+        for (const LcdLayoutWidget &w : s.widgets) {
+            fprintf(out, "    {\"%s\", %u, %u, %u, %u, %u, {}},\n", w.name, w.type, w.col, w.row, w.width, w.height);
+        }
+    }
+    if (!widget_count) fprintf(out, "    {},\n");
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "static inline esp_err_t lcd_show_screen(LcdPanel &panel, LcdSettings &settings, LcdScreenId id)\n{\n");
+    fprintf(out, "    return lcd_show_screen(panel, settings, lcd_screens[id], lcd_screen_glyphs);\n}\n\n");
+    fprintf(out, "static inline LcdRegion *lcd_lease_widget(LcdPanel &panel, LcdWidgetId id)\n{\n");
+    fprintf(out, "    const LcdLayoutWidget &w = lcd_widgets[id];\n");
+    fprintf(out, "    return panel.lease(w.col, w.row, w.width, w.height);\n}\n");
+    for (const Screen &s : screens) {
+        for (size_t f = 0; f < s.fields.size(); f++) {
+            std::string fn = identifier(s.name, false) + "_" + identifier(s.fields[f].name, false);
+            std::string id = "LCD_FIELD_" + identifier(s.name, true) + "_" + identifier(s.fields[f].name, true);
+            const char *type = s.hints[f].format.empty() ? nullptr : conversion(s.hints[f].format);
+            if (type) {
+                fprintf(out, "\nstatic inline void lcd_set_%s(LcdPanel &panel, %s%svalue)\n{\n", fn.c_str(), type,
+                        type[strlen(type) - 1] == '*' ? "" : " ");
+                fprintf(out, "    lcd_field_printf(panel, &lcd_fields[%s], value);\n}\n", id.c_str());
+            } else {
+                fprintf(out, "\nstatic inline void lcd_set_%s(LcdPanel &panel, const char *text)\n{\n", fn.c_str());
+                fprintf(out, "    const LcdFieldSpec &f = lcd_fields[%s];\n", id.c_str());
+                fprintf(out, "    lcd_put_field(panel, f.col, f.row, f.width, f.align, text);\n}\n");
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bool header = argc == 4 && strcmp(argv[1], "--header") == 0;
+    if (argc != 3 && !header) {
+        fprintf(stderr, "usage: %s screens.txt layout.bin\n       %s --header screens.txt lcd_screens.h\n", argv[0],
+                argv[0]);
+        return 2;
+    }
+    const char *input = argv[argc - 2];
+    const char *output = argv[argc - 1];
+    FILE *in = fopen(input, "r");
+    if (!in) {
+        perror(input);
+        return 1;
+    }
+    bool ok = parse(in);
+    fclose(in);
+    if (!ok) return 1;
+
+    std::vector<size_t> tx_bytes;
+    std::vector<uint8_t> image = build(tx_bytes);
+    fprintf(stderr, "%zu screens, %zu glyphs, %zu byte image\n", screens.size(), glyphs.size(), image.size());
+    if (!check_budget() || verify(image) != 0) return 1;
+
+    FILE *out = fopen(output, header ? "w" : "wb");
+    if (!out) {
+        perror(output);
+        return 1;
+    }
+    if (header) {
+        emit_header(out, image, input, output);
+    } else if (fwrite(image.data(), 1, image.size(), out) != image.size()) {
+        perror(output);
+        fclose(out);
+        return 1;
+    }
+    fclose(out);
+    return 0;
+}
@@ -0,0 +1,196 @@
+/**
+ * @file lcd_emulator.h
+ * @brief Host-side SerLCD model: a transport that decodes the I2C byte stream into
+ *        HD44780 DDRAM, CGRAM and display shift.
+ *
+ * Models what the render engine relies on: text written at the address counter, '|'
+ * settings (clear, custom characters, the rest skipped with their arguments) and raw
+ * HD44780 commands through 0xFE (DDRAM address, clear, home, display shift). DDRAM is
+ * 2-line: 0x00-0x27 and 0x40-0x67, and the address counter runs from one line into
+ * the other like the controller's does. The firmware's own line wrapping is not
+ * modelled; the engine always sets the address when it starts a row.
+ *
+ * Constructed with pcf8574 set, it decodes a PCF8574 backpack instead: expander bytes
+ * with the LCD_PCF8574_* wiring, latched on enable falling edges, 8-bit until a 4-bit
+ * function set, as LcdPcf8574Transport drives it.
+ */
+#pragma once
+
+#include <string.h>
+#include <string>
+
+#include "lcd_frame.h"
+#include "lcd_transport.h"
+
+class LcdEmulator : public LcdTransport {
+public:
+    LcdEmulator(uint8_t cols = 20, uint8_t rows = 4, bool pcf8574 = false) : _cols(cols), _rows(rows), _pcf8574(pcf8574)
+    {
+        clear();
+    }
+
+    esp_err_t write(uint8_t addr, const uint8_t *data, size_t len, uint32_t timeout_ms) override
+    {
+        (void)addr; (void)timeout_ms;
+        if (!_powered) return ESP_FAIL;
+        bytes += len;
+        writes++;
+        if (_pcf8574) {
+            for (size_t i = 0; i < len; i++) expander(data[i]);
+            return ESP_OK;
+        }
+        for (size_t i = 0; i < len; i++) {
+            uint8_t c = data[i];
+            if (c == LCD_CMD_SPECIAL && i + 1 < len) {
+                command(data[++i]);
+            } else if (c == LCD_CMD_SETTING && i + 1 < len) {
+                i += setting(&data[i + 1], len - i - 1);
+            } else {
+                put(c);
+            }
+        }
+        return ESP_OK;
+    }
+
+    esp_err_t probe(uint8_t addr, uint32_t timeout_ms) override
+    {
+        (void)addr; (void)timeout_ms;
+        return _powered ? ESP_OK : ESP_FAIL;
+    }
+
+    /**
+     * @brief Cut or restore power. While off, every transfer fails. At power-up the
+     *        display is blank and a PCF8574 controller is back in 8-bit mode.
+     */
+    void power(bool on)
+    {
+        if (on && !_powered) {
+            clear();
+            _four_bit = false;
+            _high_done = false;
+        }
+        _powered = on;
+    }
+
+    /**
+     * @brief The visible cells of @p row, shift applied. CGRAM codes show as '0'-'7'.
+     */
+    std::string row(uint8_t row) const
+    {
+        std::string out;
+        for (uint8_t col = 0; col < _cols; col++) {
+            uint8_t line = (row & 1) ? 0x40 : 0x00;
+            uint8_t column = (uint8_t)(((row >= 2) ? _cols : 0) + col);
+            if (_rows <= 2) column = (uint8_t)((column + shift) % LCD_DDRAM_LINE); // 4 lines: the firmware never shifts
+            uint8_t c = ddram[line + column];
+            out += c < 8 ? (char)('0' + c) : (char)c;
+        }
+        return out;
+    }
+
+    uint8_t ddram[0x80];
+    uint8_t cgram[8][8];
+    uint8_t shift = 0; /*!< display shifted left by this many columns */
+    bool backlight = true;
+    size_t bytes = 0;
+    size_t writes = 0;
+    size_t glyph_loads = 0;
+
+private:
+    void clear()
+    {
+        memset(ddram, ' ', sizeof(ddram));
+        _ac = 0;
+        _cgram = -1;
+        shift = 0;
+    }
+
+    void expander(uint8_t bits)
+    {
+        backlight = bits & LCD_PCF8574_BL;
+        bool falling = (_pins & LCD_PCF8574_EN) && !(bits & LCD_PCF8574_EN);
+        _pins = bits;
+        if (!falling) return;
+        uint8_t nibble = bits & 0xF0;
+        if (!_four_bit) {
+            if (nibble == 0x20) _four_bit = true; // function set, DL = 0
+            return;
+        }
+        if (!_high_done) {
+            _high = nibble;
+            _high_done = true;
+            return;
+        }
+        _high_done = false;
+        uint8_t byte = (uint8_t)(_high | nibble >> 4);
+        if (bits & LCD_PCF8574_RS) {
+            put(byte);
+        } else {
+            command(byte);
+        }
+    }
+
+    void put(uint8_t c)
+    {
+        if (_cgram >= 0) {
+            cgram[_cgram / 8][_cgram % 8] = c & 0x1F;
+            _cgram = (_cgram + 1) % 64;
+            return;
+        }
+        ddram[_ac] = c;
+        // 0x27 runs on to 0x40 and 0x67 back to 0x00
+        _ac = (_ac & 0x40) ? (_ac == 0x67 ? 0x00 : _ac + 1) : (_ac == 0x27 ? 0x40 : _ac + 1);
+    }
+
+    void command(uint8_t cmd)
+    {
+        if (cmd & 0x80) {
+            _ac = cmd & 0x7F;
+            _cgram = -1;
+        } else if ((cmd & 0xC0) == 0x40) {
+            _cgram = cmd & 0x3F;
+            glyph_loads += (_cgram % 8) == 0;
+        } else if (cmd == 0x01) {
+            clear();
+        } else if ((cmd & 0xFE) == LCD_CMD_HOME) {
+            _ac = 0;
+            _cgram = -1;
+            shift = 0;
+        } else if ((cmd & 0xF8) == 0x18) { // display shift, R/L in bit 2
+            shift = (uint8_t)((cmd & 0x04) ? (shift + LCD_DDRAM_LINE - 1) % LCD_DDRAM_LINE : (shift + 1) % LCD_DDRAM_LINE);
+        }
+    }
+
+    /**
+     * @return argument bytes consumed after the '|' prefix
+     */
+    size_t setting(const uint8_t *args, size_t left)
+    {
+        uint8_t cmd = args[0];
+        if (cmd == LCD_SETTING_CLEAR) {
+            clear();
+        } else if (cmd >= LCD_SETTING_CREATE_CHAR && cmd < LCD_SETTING_CREATE_CHAR + 8 && left >= 9) {
+            memcpy(cgram[cmd - LCD_SETTING_CREATE_CHAR], &args[1], 8);
+            glyph_loads++;
+            return 9;
+        } else if (cmd >= LCD_CMD_CUSTOM_CHAR && cmd < LCD_CMD_CUSTOM_CHAR + 8) {
+            put((uint8_t)(cmd - LCD_CMD_CUSTOM_CHAR));
+        } else if (cmd == 0x2B) { // fast backlight: r g b
+            return 4;
+        } else if (cmd == 0x18) { // contrast
+            return 2;
+        }
+        return 1;
+    }
+
+    const uint8_t _cols;
+    const uint8_t _rows;
+    const bool _pcf8574;
+    uint8_t _ac = 0;     /*!< DDRAM address counter */
+    int _cgram = -1;     /*!< CGRAM address counter while writing CGRAM, else -1 */
+    uint8_t _pins = 0;   /*!< last expander byte */
+    bool _four_bit = false;
+    bool _high_done = false; /*!< first nibble of a byte latched */
+    uint8_t _high = 0;
+    bool _powered = true;
+};
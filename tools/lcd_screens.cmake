@@ -0,0 +1,39 @@
+# Compile a declarative screen description into a header at build time.
+#
+# From a component's CMakeLists.txt, after idf_component_register():
+#
+#     include(${PROJECT_DIR}/tools/lcd_screens.cmake)
+#     lcd_compile_screens(screens.txt lcd_screens.h)
+#
+# tools/layout_gen is built for the host with the host C++ compiler, then run on the
+# description whenever it changes. Layout errors and fields over the bus budget fail
+# the build. The header lands in the component's binary directory, which is added to
+# its include path. See main/lcd_screen.h for what the header contains.
+
+set(LCD_SCREENS_TOOLS_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+function(lcd_compile_screens description header)
+    find_program(LCD_HOST_CXX NAMES c++ g++ clang++ REQUIRED)
+    get_filename_component(description ${description} ABSOLUTE)
+    get_filename_component(root ${LCD_SCREENS_TOOLS_DIR} DIRECTORY)
+    file(GLOB engine ${root}/main/lcd_*.cpp)
+    set(tool ${CMAKE_CURRENT_BINARY_DIR}/layout_gen)
+    set(output ${CMAKE_CURRENT_BINARY_DIR}/${header})
+
+    add_custom_command(OUTPUT ${tool}
+        COMMAND ${LCD_HOST_CXX} -O2 -std=c++20 -pthread -I${root}/main -I${LCD_SCREENS_TOOLS_DIR}
+                ${LCD_SCREENS_TOOLS_DIR}/layout_gen.cpp ${engine} -o ${tool}
+        DEPENDS ${LCD_SCREENS_TOOLS_DIR}/layout_gen.cpp ${LCD_SCREENS_TOOLS_DIR}/lcd_emulator.h ${engine}
+        COMMENT "Building layout_gen for the host"
+        VERBATIM)
+    add_custom_command(OUTPUT ${output}
+        COMMAND ${tool} --header ${description} ${output}
+        DEPENDS ${tool} ${description}
+        COMMENT "Compiling screens from ${description}"
+        VERBATIM)
+
+    get_filename_component(name ${header} NAME_WE)
+    add_custom_target(${COMPONENT_NAME}_${name} DEPENDS ${output})
+    add_dependencies(${COMPONENT_LIB} ${COMPONENT_NAME}_${name})
+    target_include_directories(${COMPONENT_LIB} PRIVATE ${CMAKE_CURRENT_BINARY_DIR})
+endfunction()
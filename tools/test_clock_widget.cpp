@@ -0,0 +1,54 @@
+/**
+ * @file test_clock_widget.cpp
+ * @brief Host check: the uptime clock leaves no stale digits when set() shortens it.
+ *
+ * Build and run on Linux from the repository root:
+ *
+ *     g++ -O2 -std=c++20 -pthread -Imain -Itools tools/test_clock_widget.cpp main/lcd_*.cpp -o test_clock_widget
+ *     ./test_clock_widget
+ *
+ * A D:HH:MM clock shows 100 days, rolls over a day boundary by tick(), then is set() to
+ * 9 days, which takes two digits fewer. The LcdEmulator must show exactly the clock
+ * text each time, with nothing left over to its right.
+ */
+#include <stdio.h>
+#include <string>
+
+#include "lcd_clock_widget.h"
+#include "lcd_emulator.h"
+#include "lcd_render_pool.h"
+
+int main()
+{
+    LcdEmulator lcd;
+    LcdTxQueue bus(lcd);
+    bus.start();
+    LcdPanel panel(0x72, 0);
+    LcdPanel *panels[] = {&panel};
+    LcdRenderPool pool({&bus}, 1);
+    panel.frame.assume_blank();
+    LcdRegion *region = panel.lease(0, 1, 20, 1);
+    LcdClockWidget clock(region, 4, 0, LCD_CLOCK_DHM);
+    int errors = 0;
+
+    auto check = [&](const char *expected) {
+        pool.render(panels, 1);
+        bus.wait_empty();
+        std::string row = "    " + std::string(expected);
+        row.resize(20, ' ');
+        if (lcd.row(1) != row) {
+            printf("shows |%s|, expected |%s|\n", lcd.row(1).c_str(), row.c_str());
+            errors++;
+        }
+    };
+    clock.set(100 * 86400 + 23 * 3600 + 59 * 60 + 59);
+    check("100:23:59");
+    clock.tick();
+    check("101:00:00");
+    clock.set(9 * 86400 + 3600);
+    check("9:01:00");
+    clock.set(0);
+    check("0:00:00");
+    printf("%d errors\n", errors);
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file test_rtc_restore.cpp
+ * @brief Host check: a shadow saved with unknown cells restores without sending them raw.
+ *
+ * Build and run on Linux from the repository root:
+ *
+ *     g++ -O2 -std=c++20 -pthread -Imain -Itools tools/test_rtc_restore.cpp main/lcd_*.cpp -o test_rtc_restore
+ *     ./test_rtc_restore
+ *
+ * A write fails, which leaves its cells LCD_SHADOW_UNKNOWN in the shadow. The panel is
+ * saved to "RTC memory" and restored into a new one, as after a deep-sleep wake, and
+ * cells on both sides of the unknown ones change, so the encoder merges across them.
+ * No 0xFE may then go out as a cell, where the SerLCD would take it for the command
+ * prefix, and the display must end up showing the frame with the unknown cells blank.
+ */
+#include <stdio.h>
+
+#include "lcd_emulator.h"
+#include "lcd_render_pool.h"
+#include "lcd_rtc_state.h"
+
+// Fails writes on request and checks that every 0xFE is followed by a set-DDRAM-address
+// command, the only raw HD44780 command the engine sends to a SerLCD without settings.
+class CheckedTransport : public LcdTransport {
+public:
+    explicit CheckedTransport(LcdEmulator &lcd) : _lcd(lcd) {}
+
+    esp_err_t write(uint8_t addr, const uint8_t *data, size_t len, uint32_t timeout_ms) override
+    {
+        if (fail_next) {
+            fail_next = false;
+            return ESP_FAIL;
+        }
+        for (size_t i = 0; i < len; i++) {
+            if (data[i] == LCD_CMD_SPECIAL && (i + 1 == len || !(data[++i] & 0x80))) raw_prefix++;
+        }
+        return _lcd.write(addr, data, len, timeout_ms);
+    }
+
+    esp_err_t probe(uint8_t addr, uint32_t timeout_ms) override { return _lcd.probe(addr, timeout_ms); }
+
+    bool fail_next = false;
+    int raw_prefix = 0;
+
+private:
+    LcdEmulator &_lcd;
+};
+
+int main()
+{
+    LcdEmulator lcd;
+    CheckedTransport transport(lcd);
+    LcdTxQueue bus(transport);
+    bus.start();
+    LcdRenderPool pool({&bus}, 1);
+    int errors = 0;
+
+    {
+        LcdPanel panel(0x72, 0);
+        LcdPanel *panels[] = {&panel};
+        panel.frame.assume_blank();
+        {
+            std::lock_guard<std::mutex> guard(panel.lock);
+            panel.frame.put(0, 0, "Sleeping at 21:30");
+        }
+        pool.render(panels, 1);
+        bus.wait_empty();
+        {
+            std::lock_guard<std::mutex> guard(panel.lock);
+            panel.frame.put(5, 0, "x");
+        }
+        transport.fail_next = true;
+        pool.render(panels, 1);
+        bus.wait_empty();
+        if (lcd_rtc_save(panel) != ESP_OK) {
+            printf("save failed\n");
+            errors++;
+        }
+    }
+
+    LcdPanel panel(0x72, 0);
+    LcdPanel *panels[] = {&panel};
+    if (!lcd_rtc_restore(panel)) {
+        printf("restore failed\n");
+        errors++;
+    }
+    {
+        std::lock_guard<std::mutex> guard(panel.lock);
+        panel.frame.put(4, 0, "E");
+        panel.frame.put(7, 0, "G");
+    }
+    pool.render(panels, 1);
+    bus.wait_empty();
+
+    const char *expected = "SleeE nG at 21:30   ";
+    if (lcd.row(0) != expected) {
+        printf("shows |%s|, expected |%s|\n", lcd.row(0).c_str(), expected);
+        errors++;
+    }
+    if (transport.raw_prefix) {
+        printf("%d cells sent as 0xFE\n", transport.raw_prefix);
+        errors++;
+    }
+    printf("%d errors\n", errors);
+    return errors ? 1 : 0;
+}